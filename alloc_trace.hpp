@@ -0,0 +1,329 @@
+#ifndef ALLOC_TRACE_HPP
+#define ALLOC_TRACE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <vector>
+
+// One allocation in a trace. `lifetime` counts allocations: the block is
+// freed right after the allocation `lifetime` events later (in trace order),
+// and 0 means it lives until the end of the trace.
+struct TraceEvent {
+    uint32_t size;
+    uint32_t lifetime;
+    uint8_t align_log2;
+    uint8_t thread;
+
+    size_t align() const {
+        return size_t(1) << align_log2;
+    }
+};
+
+// Parameters for AllocTrace::synthesize()
+struct SyntheticTraceConfig {
+    size_t allocations = 100000;
+    size_t threads = 1;
+    uint64_t seed = 1;
+
+    // Sizes are drawn from min_size, min_size + granularity, ... max_size
+    // with Zipfian weights 1/rank^zipf_exponent, so small sizes dominate
+    size_t min_size = 8;
+    size_t max_size = 4096;
+    size_t granularity = 8;
+    double zipf_exponent = 1.2;
+
+    // Lifetimes follow phases of phase_length allocations: most blocks die
+    // when their phase ends, short_lived_fraction are temporaries freed
+    // within short_lifetime allocations, and long_lived_fraction survive to
+    // the end of the trace
+    size_t phase_length = 1000;
+    double short_lived_fraction = 0.3;
+    size_t short_lifetime = 16;
+    double long_lived_fraction = 0.05;
+
+    // Fraction of requests that ask for 64-byte (cache line) alignment
+    double cache_aligned_fraction = 0.02;
+};
+
+// Allocation trace that can be replayed against any allocator. Traces are
+// recorded elsewhere and loaded from a compact binary file, or synthesized.
+//
+// File layout (all integers little-endian):
+//   "ATRC"  u32 version  u32 thread_count  u64 event_count
+//   event_count x { u32 size  u32 lifetime  u8 align_log2  u8 thread  u16 0 }
+class AllocTrace {
+private:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t RECORD_SIZE = 12;
+
+public:
+    // Each event stores its thread in one byte
+    static constexpr size_t MAX_THREADS = 256;
+
+private:
+
+    std::vector<TraceEvent> events_;
+    size_t threads_;
+
+    static void put(std::ostream& out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    static uint64_t get(const unsigned char* bytes, size_t count) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < count; ++i) {
+            value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    static uint8_t log2(size_t align) {
+        uint8_t result = 0;
+        while ((size_t(1) << result) < align) {
+            ++result;
+        }
+        return result;
+    }
+
+public:
+    AllocTrace() : threads_(1) {}
+
+    // Append an allocation; `align` must be a power of two
+    void push(size_t size, size_t align, size_t lifetime, size_t thread = 0) {
+        events_.push_back(TraceEvent{static_cast<uint32_t>(size), static_cast<uint32_t>(lifetime),
+                                     log2(align), static_cast<uint8_t>(thread)});
+        threads_ = std::max(threads_, thread + 1);
+    }
+
+    const std::vector<TraceEvent>& events() const {
+        return events_;
+    }
+
+    // Method to get the number of allocations
+    size_t size() const {
+        return events_.size();
+    }
+
+    // Method to get the number of threads the trace was recorded on
+    size_t thread_count() const {
+        return threads_;
+    }
+
+    // Method to get the bytes a bump arena needs to replay `thread`'s events
+    // (all threads when negative) without reclaiming anything
+    size_t total_bytes(int thread = -1) const {
+        size_t total = 0;
+        for (const TraceEvent& event : events_) {
+            if (thread < 0 || event.thread == static_cast<size_t>(thread)) {
+                total += event.size + event.align() - 1;
+            }
+        }
+        return total;
+    }
+
+    bool save(std::ostream& out) const {
+        out.write("ATRC", 4);
+        put(out, VERSION, 4);
+        put(out, threads_, 4);
+        put(out, events_.size(), 8);
+        for (const TraceEvent& event : events_) {
+            put(out, event.size, 4);
+            put(out, event.lifetime, 4);
+            put(out, event.align_log2, 1);
+            put(out, event.thread, 1);
+            put(out, 0, 2);
+        }
+        return static_cast<bool>(out);
+    }
+
+    // Replace the trace with one read from `in`. Returns false and leaves the
+    // trace empty on a bad header, unknown version, a thread count of 0 or
+    // above MAX_THREADS, an event on a thread outside that count, or a
+    // truncated file.
+    bool load(std::istream& in) {
+        events_.clear();
+        threads_ = 1;
+
+        unsigned char header[20];
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+            !std::equal(header, header + 4, "ATRC") || get(header + 4, 4) != VERSION) {
+            return false;
+        }
+        uint64_t threads = get(header + 8, 4);
+        uint64_t count = get(header + 12, 8);
+        if (threads == 0 || threads > MAX_THREADS) {
+            return false;
+        }
+
+        std::vector<TraceEvent> events;
+        unsigned char record[RECORD_SIZE];
+        for (uint64_t i = 0; i < count; ++i) {
+            if (!in.read(reinterpret_cast<char*>(record), sizeof(record)) || record[8] >= 32 ||
+                record[9] >= threads) {
+                return false;
+            }
+            events.push_back(TraceEvent{static_cast<uint32_t>(get(record, 4)),
+                                        static_cast<uint32_t>(get(record + 4, 4)),
+                                        record[8], record[9]});
+        }
+        events_.swap(events);
+        threads_ = static_cast<size_t>(threads);
+        return true;
+    }
+
+    // Generate a reproducible trace from `config`
+    static AllocTrace synthesize(const SyntheticTraceConfig& config) {
+        std::mt19937_64 rng(config.seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        // Cumulative Zipf weights over the size ranks
+        size_t granularity = std::max<size_t>(config.granularity, 1);
+        size_t min_size = std::max<size_t>(config.min_size, 1);
+        size_t ranks = config.max_size > min_size ? (config.max_size - min_size) / granularity + 1 : 1;
+        std::vector<double> cdf(ranks);
+        double sum = 0;
+        for (size_t rank = 0; rank < ranks; ++rank) {
+            sum += 1.0 / std::pow(static_cast<double>(rank + 1), config.zipf_exponent);
+            cdf[rank] = sum;
+        }
+
+        size_t threads = std::min<size_t>(std::max<size_t>(config.threads, 1), MAX_THREADS);
+        size_t phase_length = std::max<size_t>(config.phase_length, 1);
+        size_t short_lifetime = std::max<size_t>(config.short_lifetime, 1);
+
+        AllocTrace trace;
+        trace.events_.reserve(config.allocations);
+        for (size_t i = 0; i < config.allocations; ++i) {
+            size_t rank = static_cast<size_t>(
+                std::lower_bound(cdf.begin(), cdf.end(), uniform(rng) * sum) - cdf.begin());
+            size_t size = min_size + std::min(rank, ranks - 1) * granularity;
+
+            // Natural alignment: the lowest set bit of the size, capped at 16
+            size_t align = std::min<size_t>(size & (~size + 1), 16);
+            if (uniform(rng) < config.cache_aligned_fraction) {
+                align = 64;
+            }
+
+            size_t lifetime;
+            double kind = uniform(rng);
+            if (kind < config.long_lived_fraction) {
+                lifetime = 0;
+            } else if (kind < config.long_lived_fraction + config.short_lived_fraction) {
+                lifetime = 1 + static_cast<size_t>(rng() % short_lifetime);
+            } else {
+                lifetime = phase_length - i % phase_length;
+            }
+            if (i + lifetime >= config.allocations) {
+                lifetime = 0;
+            }
+
+            trace.push(size, align, lifetime, static_cast<size_t>(rng() % threads));
+        }
+        trace.threads_ = threads;
+        return trace;
+    }
+};
+
+// Replays one thread's share of a trace (or the whole trace) against an
+// allocator given as alloc(size, align) -> void* and free(ptr, size, align)
+// callables. The alloc/free schedule is built up front so run() itself only
+// walks an array. Frees happen on the allocating thread.
+class TraceReplay {
+private:
+    struct Op {
+        uint32_t index;        // Event index
+        bool free;
+    };
+
+    const AllocTrace& trace_;
+    std::vector<Op> ops_;
+    std::vector<void*> slots_;
+    size_t allocations_;
+    size_t peak_bytes_;
+
+public:
+    explicit TraceReplay(const AllocTrace& trace, int thread = -1)
+        : trace_(trace), slots_(trace.size(), nullptr), allocations_(0), peak_bytes_(0) {
+        const std::vector<TraceEvent>& events = trace.events();
+        auto selected = [thread](const TraceEvent& event) {
+            return thread < 0 || event.thread == static_cast<size_t>(thread);
+        };
+
+        // Bucket each selected event by the event it is freed after
+        std::vector<std::vector<uint32_t>> frees(events.size());
+        std::vector<uint32_t> at_end;
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (!selected(events[i])) {
+                continue;
+            }
+            size_t lifetime = events[i].lifetime;
+            if (lifetime == 0 || i + lifetime >= events.size()) {
+                at_end.push_back(static_cast<uint32_t>(i));
+            } else {
+                frees[i + lifetime].push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        size_t live = 0;
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (selected(events[i])) {
+                ops_.push_back(Op{static_cast<uint32_t>(i), false});
+                ++allocations_;
+                live += events[i].size;
+                peak_bytes_ = std::max(peak_bytes_, live);
+            }
+            for (uint32_t index : frees[i]) {
+                ops_.push_back(Op{index, true});
+                live -= events[index].size;
+            }
+        }
+        for (uint32_t index : at_end) {
+            ops_.push_back(Op{index, true});
+        }
+    }
+
+    // Run the schedule once. Returns the number of failed allocations.
+    template<typename Alloc, typename Free>
+    size_t run(Alloc&& alloc, Free&& free) {
+        const TraceEvent* events = trace_.events().data();
+        void** slots = slots_.data();
+        size_t failures = 0;
+        for (const Op& op : ops_) {
+            const TraceEvent& event = events[op.index];
+            if (op.free) {
+                if (slots[op.index] != nullptr) {
+                    free(slots[op.index], event.size, event.align());
+                    slots[op.index] = nullptr;
+                }
+                continue;
+            }
+            void* ptr = alloc(event.size, event.align());
+            if (ptr != nullptr && event.size > 0) {
+                static_cast<char*>(ptr)[0] = 1;
+            } else if (ptr == nullptr && event.size > 0) {
+                ++failures;
+            }
+            slots[op.index] = ptr;
+        }
+        return failures;
+    }
+
+    // Method to get the number of allocations in the schedule
+    size_t allocations() const {
+        return allocations_;
+    }
+
+    // Method to get the most bytes live at once, ignoring alignment
+    size_t peak_bytes() const {
+        return peak_bytes_;
+    }
+};
+
+#endif // ALLOC_TRACE_HPP
@@ -0,0 +1,418 @@
+#ifndef ARENA_INSTRUMENT_HPP
+#define ARENA_INSTRUMENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+// ARENA_ASAN is set when AddressSanitizer is on: __SANITIZE_ADDRESS__ on
+// GCC, __has_feature(address_sanitizer) on Clang
+#if defined(__SANITIZE_ADDRESS__)
+#define ARENA_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ARENA_ASAN 1
+#endif
+#endif
+
+#ifdef ARENA_ASAN
+#include <sanitizer/asan_interface.h>
+#endif
+
+// Make [memory, memory + size) unaddressable to AddressSanitizer; no-op
+// without it
+inline void arena_poison(const void* memory, size_t size) {
+#ifdef ARENA_ASAN
+    __asan_poison_memory_region(memory, size);
+#else
+    (void)memory;
+    (void)size;
+#endif
+}
+
+// Make [memory, memory + size) addressable again
+inline void arena_unpoison(const void* memory, size_t size) {
+#ifdef ARENA_ASAN
+    __asan_unpoison_memory_region(memory, size);
+#else
+    (void)memory;
+    (void)size;
+#endif
+}
+
+// Source location of an allocation request. Allocation methods take one as
+// a trailing argument defaulted to CallSite::current(), which resolves to
+// the caller's file and line; with instrumentation off it is never read and
+// folds away.
+struct CallSite {
+    const char* file;
+    unsigned line;
+
+#if defined(__GNUC__) || defined(__clang__)
+    static constexpr CallSite current(const char* file = __builtin_FILE(),
+                                      unsigned line = __builtin_LINE()) {
+        return CallSite{file, line};
+    }
+#else
+    static constexpr CallSite current() {
+        return CallSite{"", 0};
+    }
+#endif
+};
+
+// Instrumentation policies for BumpResource / BumpAllocator / BumpArena. The
+// allocator calls each hook only when `enabled` is true (under if constexpr),
+// and inherits the policy as an empty base, so NoInstrumentation adds no
+// code and no bytes. `redzone` bytes are reserved after every allocation.
+//
+//   on_attach(memory, capacity)       when the allocator takes its buffer
+//   on_alloc(ptr, size, align, padding, used, site)
+//   on_failure(size, align, site)
+//   on_dealloc(used)                  after a dealloc(); used is bytes still in use
+//   on_release(begin, end, used)      before [begin, end) is dropped by reset(),
+//                                     rewind() or the last dealloc()
+//   on_detach(memory, capacity)       before the buffer is given back
+struct NoInstrumentation {
+    static constexpr bool enabled = false;
+    static constexpr size_t redzone = 0;
+
+    void on_attach(char*, size_t) {}
+    void on_alloc(const void*, size_t, size_t, size_t, size_t, const CallSite&) {}
+    void on_failure(size_t, size_t, const CallSite&) {}
+    void on_dealloc(size_t) {}
+    void on_release(char*, char*, size_t) {}
+    void on_detach(char*, size_t) {}
+};
+
+// Counters for finding what blows an arena budget: high-water mark, bytes
+// requested, failures and lifetime padding, broken down per call site into
+// a table of Sites entries (call sites past that are pooled into one
+// overflow row). With TraceEvents > 0 the last TraceEvents events are kept
+// in a ring buffer for dump().
+template<size_t Sites = 32, size_t TraceEvents = 0>
+class ArenaInstrumentation {
+    static_assert(Sites > 0 && (Sites & (Sites - 1)) == 0, "Sites must be a power of two");
+
+    static constexpr size_t RING = TraceEvents > 0 ? TraceEvents : 1;
+
+public:
+    // Totals for one call site
+    struct SiteStats {
+        CallSite site;
+        size_t allocations;
+        size_t bytes;
+        size_t failures;
+    };
+
+    enum EventKind : uint8_t {
+        ALLOC,
+        FAILURE,
+        DEALLOC,
+        RELEASE
+    };
+
+    // One ring-buffer entry. `used` is the arena fill level after the event.
+    struct Event {
+        EventKind kind;
+        size_t size;
+        size_t used;
+        CallSite site;
+    };
+
+private:
+    size_t high_water_;
+    size_t bytes_requested_;
+    size_t failures_;
+    size_t padding_;
+    SiteStats sites_[Sites];
+    SiteStats overflow_;
+    Event events_[RING];
+    size_t event_count_;       // Events ever recorded
+
+    static bool same_site(const CallSite& a, const CallSite& b) {
+        return a.line == b.line && (a.file == b.file || std::strcmp(a.file, b.file) == 0);
+    }
+
+    SiteStats& find_site(const CallSite& site) {
+        size_t hash = reinterpret_cast<uintptr_t>(site.file) ^ (size_t(site.line) * 0x9e3779b9u);
+        for (size_t probe = 0; probe < Sites; ++probe) {
+            SiteStats& entry = sites_[(hash + probe) & (Sites - 1)];
+            if (entry.site.file == nullptr) {
+                entry.site = site;
+                return entry;
+            }
+            if (same_site(entry.site, site)) {
+                return entry;
+            }
+        }
+        return overflow_;
+    }
+
+    void record(EventKind kind, size_t size, size_t used, const CallSite& site) {
+        if (TraceEvents > 0) {
+            events_[event_count_ % RING] = Event{kind, size, used, site};
+            ++event_count_;
+        }
+    }
+
+    static const char* kind_name(EventKind kind) {
+        static const char* const names[] = {"alloc", "failure", "dealloc", "release"};
+        return names[kind];
+    }
+
+public:
+    static constexpr bool enabled = true;
+    static constexpr size_t redzone = 0;
+
+    ArenaInstrumentation() {
+        clear();
+    }
+
+    void on_attach(char*, size_t) {}
+    void on_detach(char*, size_t) {}
+
+    void on_alloc(const void*, size_t size, size_t, size_t padding, size_t used, const CallSite& site) {
+        if (used > high_water_) {
+            high_water_ = used;
+        }
+        bytes_requested_ += size;
+        padding_ += padding;
+        SiteStats& entry = find_site(site);
+        ++entry.allocations;
+        entry.bytes += size;
+        record(ALLOC, size, used, site);
+    }
+
+    void on_failure(size_t size, size_t, const CallSite& site) {
+        ++failures_;
+        ++find_site(site).failures;
+        record(FAILURE, size, 0, site);
+    }
+
+    void on_dealloc(size_t used) {
+        record(DEALLOC, 0, used, CallSite{"", 0});
+    }
+
+    void on_release(char* begin, char* end, size_t used) {
+        record(RELEASE, static_cast<size_t>(end - begin), used, CallSite{"", 0});
+    }
+
+    // Method to forget everything recorded so far
+    void clear() {
+        high_water_ = 0;
+        bytes_requested_ = 0;
+        failures_ = 0;
+        padding_ = 0;
+        for (SiteStats& entry : sites_) {
+            entry = SiteStats{CallSite{nullptr, 0}, 0, 0, 0};
+        }
+        overflow_ = SiteStats{CallSite{"<other>", 0}, 0, 0, 0};
+        event_count_ = 0;
+    }
+
+    // Method to get the most bytes the arena has had in use (with padding)
+    size_t high_water() const {
+        return high_water_;
+    }
+
+    // Method to get the sum of all successful request sizes
+    size_t bytes_requested() const {
+        return bytes_requested_;
+    }
+
+    // Method to get the number of requests that did not fit
+    size_t failures() const {
+        return failures_;
+    }
+
+    // Method to get alignment padding over the arena's lifetime; unlike
+    // padding_waste() this survives reset and rewind
+    size_t total_padding() const {
+        return padding_;
+    }
+
+    // Method to get the totals recorded for `site`, or zeros if it never
+    // allocated
+    SiteStats site_stats(const CallSite& site) const {
+        for (const SiteStats& entry : sites_) {
+            if (entry.site.file != nullptr && same_site(entry.site, site)) {
+                return entry;
+            }
+        }
+        return SiteStats{site, 0, 0, 0};
+    }
+
+    // Method to get the number of ring-buffer events still held
+    size_t event_count() const {
+        return event_count_ < TraceEvents ? event_count_ : TraceEvents;
+    }
+
+    // Method to get held event `index`, oldest first
+    const Event& event(size_t index) const {
+        size_t first = event_count_ - event_count();
+        return events_[(first + index) % RING];
+    }
+
+    // Write the totals, per-site table (largest byte count first) and any
+    // held events
+    void dump(std::ostream& out) const {
+        out << "high water " << high_water_ << " bytes, requested " << bytes_requested_
+            << " bytes, padding " << padding_ << " bytes, failures " << failures_ << "\n";
+
+        const SiteStats* order[Sites + 1];
+        size_t count = 0;
+        for (const SiteStats& entry : sites_) {
+            if (entry.site.file != nullptr) {
+                order[count++] = &entry;
+            }
+        }
+        if (overflow_.allocations > 0 || overflow_.failures > 0) {
+            order[count++] = &overflow_;
+        }
+        for (size_t i = 1; i < count; ++i) {
+            for (size_t j = i; j > 0 && order[j]->bytes > order[j - 1]->bytes; --j) {
+                const SiteStats* swap = order[j];
+                order[j] = order[j - 1];
+                order[j - 1] = swap;
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            out << "  " << order[i]->site.file << ":" << order[i]->site.line << "  "
+                << order[i]->allocations << " allocations, " << order[i]->bytes << " bytes, "
+                << order[i]->failures << " failures\n";
+        }
+
+        for (size_t i = 0; i < event_count(); ++i) {
+            const Event& e = event(i);
+            out << "  [" << i << "] " << kind_name(e.kind) << " size " << e.size
+                << " used " << e.used;
+            if (e.kind == ALLOC || e.kind == FAILURE) {
+                out << " at " << e.site.file << ":" << e.site.line;
+            }
+            out << "\n";
+        }
+    }
+};
+
+// Hardened policy for hunting arena corruption. Every allocation is
+// followed by a Redzone-byte guard, and released memory is poisoned:
+//
+//  - under AddressSanitizer the arena starts poisoned, each allocation is
+//    unpoisoned on the way out and guards and released ranges are poisoned
+//    again, so overruns and use-after-rewind are reported at the access;
+//  - otherwise new memory is filled with 0xCD, guards with 0xFD and released
+//    memory with 0xDD, and guards are checked on release and by verify().
+//    A damaged guard is reported through the corruption handler, which
+//    defaults to printing the allocating call site and aborting.
+template<size_t Redzone = 16>
+class ArenaDebug {
+public:
+    static constexpr unsigned char FRESH = 0xCD;
+    static constexpr unsigned char GUARD = 0xFD;
+    static constexpr unsigned char FREED = 0xDD;
+
+    using CorruptionHandler = void (*)(const CallSite& site, const void* guard);
+
+private:
+    struct Guard {
+        char* begin;
+        CallSite site;
+    };
+
+    std::vector<Guard> guards_;    // Live guards in address order
+    CorruptionHandler handler_;
+    size_t corruptions_;
+
+    static void report(const CallSite& site, const void* guard) {
+        std::fprintf(stderr, "arena redzone at %p overwritten; block allocated at %s:%u\n",
+                     guard, site.file, site.line);
+        std::abort();
+    }
+
+    bool intact(const Guard& guard) const {
+#ifdef ARENA_ASAN
+        (void)guard;
+        return true;
+#else
+        for (size_t i = 0; i < Redzone; ++i) {
+            if (static_cast<unsigned char>(guard.begin[i]) != GUARD) {
+                return false;
+            }
+        }
+        return true;
+#endif
+    }
+
+    void check(const Guard& guard) {
+        if (!intact(guard)) {
+            ++corruptions_;
+            handler_(guard.site, guard.begin);
+        }
+    }
+
+public:
+    static constexpr bool enabled = true;
+    static constexpr size_t redzone = Redzone;
+
+    ArenaDebug() : handler_(report), corruptions_(0) {}
+
+    void on_attach(char* memory, size_t capacity) {
+        arena_poison(memory, capacity);
+    }
+
+    void on_alloc(void* ptr, size_t size, size_t, size_t, size_t, const CallSite& site) {
+        char* begin = static_cast<char*>(ptr);
+        arena_unpoison(begin, size);
+#ifndef ARENA_ASAN
+        std::memset(begin, FRESH, size);
+        std::memset(begin + size, GUARD, Redzone);
+#endif
+        if (Redzone > 0) {
+            guards_.push_back(Guard{begin + size, site});
+        }
+    }
+
+    void on_failure(size_t, size_t, const CallSite&) {}
+    void on_dealloc(size_t) {}
+
+    void on_release(char* begin, char* end, size_t) {
+        while (!guards_.empty() && guards_.back().begin >= begin) {
+            check(guards_.back());
+            guards_.pop_back();
+        }
+#ifndef ARENA_ASAN
+        std::memset(begin, FREED, static_cast<size_t>(end - begin));
+#endif
+        arena_poison(begin, static_cast<size_t>(end - begin));
+    }
+
+    void on_detach(char* memory, size_t capacity) {
+        guards_.clear();
+        arena_unpoison(memory, capacity);
+    }
+
+    // Method to check every live guard; returns false if any was damaged
+    bool verify() {
+        size_t before = corruptions_;
+        for (const Guard& guard : guards_) {
+            check(guard);
+        }
+        return corruptions_ == before;
+    }
+
+    // Method to replace the handler called for each damaged guard
+    void set_corruption_handler(CorruptionHandler handler) {
+        handler_ = handler;
+    }
+
+    // Method to get the number of damaged guards found so far
+    size_t corruptions() const {
+        return corruptions_;
+    }
+};
+
+#endif // ARENA_INSTRUMENT_HPP
@@ -0,0 +1,149 @@
+#ifndef ARENA_STORAGE_HPP
+#define ARENA_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define ARENA_STORAGE_HAS_MMAP 1
+#endif
+
+// Storage policies for BumpAllocator. Each provides data() for the start of
+// an N-byte, max_align_t-aligned buffer and discard(used), which is called on
+// an explicit reset() so the policy can hand touched pages back to the OS.
+// Policies that acquire memory throw std::bad_alloc from their constructor on
+// failure, as operator new would.
+
+// Holds the storage in a base class listed ahead of anything built over
+// it, so the storage is constructed before the arena takes data() from it
+template<typename Storage>
+struct BumpStorageHolder {
+    Storage storage_;
+};
+
+// Buffer embedded in the allocator object (the original layout)
+template<size_t N>
+class InlineStorage {
+private:
+    alignas(std::max_align_t) char memory_[N];
+
+public:
+    char* data() { return memory_; }
+    const char* data() const { return memory_; }
+    void discard(size_t /*used*/) {}
+};
+
+// Buffer on the heap, so large arenas stay off the stack
+template<size_t N>
+class HeapStorage {
+private:
+    char* memory_;
+
+public:
+    HeapStorage() : memory_(static_cast<char*>(std::malloc(N ? N : 1))) {
+        if (memory_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    HeapStorage(const HeapStorage&) = delete;
+    HeapStorage& operator=(const HeapStorage&) = delete;
+
+    ~HeapStorage() {
+        std::free(memory_);
+    }
+
+    char* data() { return memory_; }
+    const char* data() const { return memory_; }
+    void discard(size_t /*used*/) {}
+};
+
+#ifdef ARENA_STORAGE_HAS_MMAP
+
+// Anonymous mapping; pages are committed on first touch and returned with
+// MADV_DONTNEED on reset. With HugePages the mapping first tries explicit
+// MAP_HUGETLB pages and otherwise asks for transparent huge pages.
+template<size_t N, bool HugePages>
+class BasicMmapStorage {
+private:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    char* memory_;
+    size_t mapped_;            // Bytes mapped, rounded to page_size_
+    size_t page_size_;         // Granularity of the mapping
+    bool hugetlb_;             // Backed by explicit huge pages
+
+    static size_t round_up(size_t value, size_t granule) {
+        return (value + granule - 1) / granule * granule;
+    }
+
+    bool map(size_t page_size, int extra_flags) {
+        size_t length = round_up(N ? N : 1, page_size);
+        void* ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+        if (ptr == MAP_FAILED) {
+            return false;
+        }
+        memory_ = static_cast<char*>(ptr);
+        mapped_ = length;
+        page_size_ = page_size;
+        return true;
+    }
+
+public:
+    BasicMmapStorage() : memory_(nullptr), mapped_(0), page_size_(0), hugetlb_(false) {
+        size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#ifdef MAP_HUGETLB
+        if (HugePages && map(HUGE_PAGE_SIZE, MAP_HUGETLB)) {
+            hugetlb_ = true;
+            return;
+        }
+#endif
+        if (!map(page_size, 0)) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (HugePages) {
+            madvise(memory_, mapped_, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    BasicMmapStorage(const BasicMmapStorage&) = delete;
+    BasicMmapStorage& operator=(const BasicMmapStorage&) = delete;
+
+    ~BasicMmapStorage() {
+        munmap(memory_, mapped_);
+    }
+
+    char* data() { return memory_; }
+    const char* data() const { return memory_; }
+
+    void discard(size_t used) {
+        size_t length = round_up(used, page_size_);
+        if (length > mapped_) {
+            length = mapped_;
+        }
+        if (length > 0) {
+            madvise(memory_, length, MADV_DONTNEED);
+        }
+    }
+
+    // Method to check whether explicit huge pages back the mapping
+    bool hugetlb() const {
+        return hugetlb_;
+    }
+};
+
+template<size_t N>
+using MmapStorage = BasicMmapStorage<N, false>;
+
+template<size_t N>
+using HugePageStorage = BasicMmapStorage<N, true>;
+
+#endif // ARENA_STORAGE_HAS_MMAP
+
+#endif // ARENA_STORAGE_HPP
@@ -0,0 +1,89 @@
+#ifndef BUMP_RESOURCE_HPP
+#define BUMP_RESOURCE_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+// std::pmr::memory_resource over any bump allocator exposing
+// alloc_aligned(size, align) and dealloc(). The allocator is borrowed and
+// must outlive the resource and every container using it. Exhaustion throws
+// std::bad_alloc as the memory_resource contract requires.
+template<typename Allocator>
+class BumpMemoryResource : public std::pmr::memory_resource {
+private:
+    Allocator& allocator_;
+
+public:
+    explicit BumpMemoryResource(Allocator& allocator) : allocator_(allocator) {}
+
+    Allocator& allocator() const {
+        return allocator_;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* ptr = allocator_.alloc_aligned(bytes, alignment);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    void do_deallocate(void* /*ptr*/, size_t /*bytes*/, size_t /*alignment*/) override {
+        allocator_.dealloc();
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Minimal C++17 Allocator for std containers that draws from a borrowed bump
+// allocator. Copies and rebinds share the same underlying allocator.
+template<typename T, typename Allocator>
+class BumpStlAllocator {
+private:
+    template<typename U, typename A>
+    friend class BumpStlAllocator;
+
+    Allocator* allocator_;
+
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = BumpStlAllocator<U, Allocator>;
+    };
+
+    explicit BumpStlAllocator(Allocator& allocator) noexcept : allocator_(&allocator) {}
+
+    template<typename U>
+    BumpStlAllocator(const BumpStlAllocator<U, Allocator>& other) noexcept
+        : allocator_(other.allocator_) {}
+
+    T* allocate(size_t n) {
+        T* ptr = allocator_->template alloc<T>(n);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    void deallocate(T* /*ptr*/, size_t /*n*/) noexcept {
+        allocator_->dealloc();
+    }
+
+    template<typename U>
+    bool operator==(const BumpStlAllocator<U, Allocator>& other) const noexcept {
+        return allocator_ == other.allocator_;
+    }
+
+    template<typename U>
+    bool operator!=(const BumpStlAllocator<U, Allocator>& other) const noexcept {
+        return allocator_ != other.allocator_;
+    }
+};
+
+#endif // BUMP_RESOURCE_HPP
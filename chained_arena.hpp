@@ -0,0 +1,261 @@
+#ifndef CHAINED_ARENA_HPP
+#define CHAINED_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Default upstream source for arena blocks
+struct MallocUpstream {
+    static void* allocate(size_t size) {
+        return std::malloc(size);
+    }
+
+    static void deallocate(void* ptr, size_t /*size*/) {
+        std::free(ptr);
+    }
+};
+
+// Bump allocator that chains new blocks from Upstream instead of failing
+// when the current block is exhausted. Block sizes grow geometrically up to
+// max_block_size; a request larger than that gets a dedicated block.
+template<typename Upstream = MallocUpstream>
+class ChainedBumpAllocator {
+private:
+    // Header placed at the start of every upstream block
+    struct alignas(std::max_align_t) Block {
+        Block* next;           // Next block in the chain
+        size_t size;           // Usable bytes following the header
+
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    Block* head_;              // Current block, older blocks chained behind it
+    Block* free_;              // Blocks recycled by reset()
+    char* next_;               // Bump pointer within the current block
+    char* end_;                // End of the current block
+    size_t initial_block_size_;
+    size_t max_block_size_;
+    size_t next_block_size_;   // Size of the next block requested upstream
+    size_t allocations_;       // Counter for allocations
+    size_t padding_waste_;     // Bytes skipped to satisfy alignment
+
+    // Make a block holding at least `size` bytes at `align` current
+    bool refill(size_t size, size_t align) {
+        if (size > SIZE_MAX - align) {
+            return false;
+        }
+        size_t needed = size + align - 1;
+
+        // Reuse a recycled block if one is large enough
+        Block** link = &free_;
+        while (*link != nullptr && (*link)->size < needed) {
+            link = &(*link)->next;
+        }
+
+        Block* block = *link;
+        if (block != nullptr) {
+            *link = block->next;
+        } else {
+            size_t block_size = next_block_size_ > needed ? next_block_size_ : needed;
+            if (block_size > SIZE_MAX - sizeof(Block)) {
+                return false;
+            }
+            void* raw = Upstream::allocate(sizeof(Block) + block_size);
+            if (raw == nullptr) {
+                return false;
+            }
+            block = static_cast<Block*>(raw);
+            block->size = block_size;
+
+            // Geometric growth, capped at the configured maximum
+            if (next_block_size_ < max_block_size_) {
+                next_block_size_ = next_block_size_ > max_block_size_ / 2
+                                       ? max_block_size_
+                                       : next_block_size_ * 2;
+            }
+        }
+
+        block->next = head_;
+        head_ = block;
+        next_ = block->data();
+        end_ = next_ + block->size;
+        return true;
+    }
+
+    static void release_chain(Block* block) {
+        while (block != nullptr) {
+            Block* next = block->next;
+            Upstream::deallocate(block, sizeof(Block) + block->size);
+            block = next;
+        }
+    }
+
+public:
+    // Checkpoint returned by mark() and restored by rewind()
+    struct Marker {
+        Block* block;
+        char* position;
+        size_t next_block_size;
+        size_t allocations;
+        size_t padding_waste;
+    };
+
+    explicit ChainedBumpAllocator(size_t initial_block_size = 4096,
+                                  size_t max_block_size = 1024 * 1024)
+        : head_(nullptr), free_(nullptr), next_(nullptr), end_(nullptr),
+          initial_block_size_(initial_block_size ? initial_block_size : 1),
+          max_block_size_(max_block_size > initial_block_size_ ? max_block_size
+                                                               : initial_block_size_),
+          next_block_size_(initial_block_size_), allocations_(0), padding_waste_(0) {}
+
+    ChainedBumpAllocator(const ChainedBumpAllocator&) = delete;
+    ChainedBumpAllocator& operator=(const ChainedBumpAllocator&) = delete;
+
+    ~ChainedBumpAllocator() {
+        release();
+    }
+
+    template<typename T>
+    T* alloc(size_t n = 1) {
+        // Guard against sizeof(T) * n overflowing
+        if (n > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(alloc_aligned(sizeof(T) * n, alignof(T)));
+    }
+
+    void* alloc_aligned(size_t size, size_t align) {
+        if (align == 0 || (align & (align - 1)) != 0) {
+            return nullptr;
+        }
+
+        // Fast path: bump within the current block
+        uintptr_t addr = reinterpret_cast<uintptr_t>(next_);
+        size_t padding = static_cast<size_t>(-addr) & (align - 1);
+        size_t remaining = remaining_space();
+        if (next_ == nullptr || padding > remaining || size > remaining - padding) {
+            // Slow path: chain a new block
+            if (!refill(size, align)) {
+                return nullptr;
+            }
+            addr = reinterpret_cast<uintptr_t>(next_);
+            padding = static_cast<size_t>(-addr) & (align - 1);
+        }
+
+        char* result = next_ + padding;
+        next_ = result + size;
+        padding_waste_ += padding;
+        ++allocations_;
+
+        return result;
+    }
+
+    // Grow the most recent allocation in place if the current block has
+    // room; returns false and changes nothing otherwise
+    bool extend(void* ptr, size_t old_size, size_t new_size) {
+        char* block = static_cast<char*>(ptr);
+        if (block == nullptr || block + old_size != next_ || new_size < old_size ||
+            new_size - old_size > remaining_space()) {
+            return false;
+        }
+        next_ = block + new_size;
+        return true;
+    }
+
+    void dealloc() {
+        if (allocations_ > 0) {
+            --allocations_;
+
+            // If all allocations are freed, recycle every block
+            if (allocations_ == 0) {
+                reset();
+            }
+        }
+    }
+
+    // Record the current block and bump position
+    Marker mark() const {
+        return Marker{head_, next_, next_block_size_, allocations_, padding_waste_};
+    }
+
+    // Release everything allocated since `marker` was taken, recycling the
+    // blocks chained after it and undoing their growth. Markers must be
+    // rewound in LIFO order.
+    void rewind(const Marker& marker) {
+        while (head_ != marker.block) {
+            Block* next = head_->next;
+            head_->next = free_;
+            free_ = head_;
+            head_ = next;
+        }
+        next_ = marker.position;
+        end_ = head_ != nullptr ? head_->data() + head_->size : nullptr;
+        next_block_size_ = marker.next_block_size;
+        allocations_ = marker.allocations;
+        padding_waste_ = marker.padding_waste;
+    }
+
+    // Drop all allocations and keep the blocks for reuse
+    void reset() {
+        while (head_ != nullptr) {
+            Block* next = head_->next;
+            head_->next = free_;
+            free_ = head_;
+            head_ = next;
+        }
+        next_ = nullptr;
+        end_ = nullptr;
+        next_block_size_ = initial_block_size_;
+        allocations_ = 0;
+        padding_waste_ = 0;
+    }
+
+    // Drop all allocations and return every block to Upstream
+    void release() {
+        release_chain(head_);
+        release_chain(free_);
+        head_ = nullptr;
+        free_ = nullptr;
+        next_ = nullptr;
+        end_ = nullptr;
+        next_block_size_ = initial_block_size_;
+        allocations_ = 0;
+        padding_waste_ = 0;
+    }
+
+    // Method to get the usable bytes of all blocks in the active chain
+    size_t capacity() const {
+        size_t total = 0;
+        for (Block* block = head_; block != nullptr; block = block->next) {
+            total += block->size;
+        }
+        return total;
+    }
+
+    // Method to get the number of blocks in the active chain
+    size_t block_count() const {
+        size_t count = 0;
+        for (Block* block = head_; block != nullptr; block = block->next) {
+            ++count;
+        }
+        return count;
+    }
+
+    // Method to get current number of allocations
+    size_t allocations() const {
+        return allocations_;
+    }
+
+    // Method to get remaining space in the current block
+    size_t remaining_space() const {
+        return static_cast<size_t>(end_ - next_);
+    }
+
+    // Method to get bytes lost to alignment padding since the last reset
+    size_t padding_waste() const {
+        return padding_waste_;
+    }
+};
+
+#endif // CHAINED_ARENA_HPP
@@ -0,0 +1,331 @@
+#ifndef CONCURRENT_ARENA_HPP
+#define CONCURRENT_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+
+// Bump allocator that several threads can share. Each allocation is a single
+// fetch_add; alignment is satisfied by reserving align - 1 extra bytes, which
+// are reported as padding waste.
+template<size_t N>
+class AtomicBumpAllocator {
+private:
+    alignas(std::max_align_t) char memory_[N];  // Fixed size memory chunk
+    std::atomic<size_t> offset_;               // Bump offset, may overshoot N
+    std::atomic<size_t> allocations_;          // Counter for allocations
+    std::atomic<size_t> padding_waste_;        // Bytes reserved for alignment
+
+public:
+    AtomicBumpAllocator() : offset_(0), allocations_(0), padding_waste_(0) {}
+
+    AtomicBumpAllocator(const AtomicBumpAllocator&) = delete;
+    AtomicBumpAllocator& operator=(const AtomicBumpAllocator&) = delete;
+
+    template<typename T>
+    T* alloc(size_t n = 1) {
+        // Guard against sizeof(T) * n overflowing
+        if (n > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(alloc_aligned(sizeof(T) * n, alignof(T)));
+    }
+
+    void* alloc_aligned(size_t size, size_t align) {
+        if (align == 0 || (align & (align - 1)) != 0 || size > N) {
+            return nullptr;
+        }
+
+        // Reserve the worst case so no retry loop is needed
+        size_t reserved = size + align - 1;
+        size_t start = offset_.fetch_add(reserved, std::memory_order_relaxed);
+        if (start > N || reserved > N - start) {
+            return nullptr;
+        }
+
+        uintptr_t addr = reinterpret_cast<uintptr_t>(memory_ + start);
+        addr = (addr + align - 1) & ~(uintptr_t(align) - 1);
+
+        padding_waste_.fetch_add(align - 1, std::memory_order_relaxed);
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+
+        return reinterpret_cast<void*>(addr);
+    }
+
+    // Only decrements the counter; space is reclaimed by reset()
+    void dealloc() {
+        size_t current = allocations_.load(std::memory_order_relaxed);
+        while (current > 0 &&
+               !allocations_.compare_exchange_weak(current, current - 1,
+                                                   std::memory_order_relaxed)) {
+        }
+    }
+
+    // Drop all allocations. Not safe while other threads are allocating.
+    void reset() {
+        offset_.store(0, std::memory_order_relaxed);
+        allocations_.store(0, std::memory_order_relaxed);
+        padding_waste_.store(0, std::memory_order_relaxed);
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    size_t allocations() const {
+        return allocations_.load(std::memory_order_relaxed);
+    }
+
+    size_t remaining_space() const {
+        size_t offset = offset_.load(std::memory_order_relaxed);
+        return offset < N ? N - offset : 0;
+    }
+
+    size_t padding_waste() const {
+        return padding_waste_.load(std::memory_order_relaxed);
+    }
+};
+
+// Shared pool of fixed-size chunks handed out to per-thread arenas. Free
+// chunks form a lock-free stack of indices; the head carries a version tag
+// in its upper 32 bits so a concurrent pop/push cannot cause ABA.
+class ChunkPool {
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    char* memory_;                             // chunk_count_ chunks, contiguous
+    size_t chunk_size_;
+    uint32_t chunk_count_;
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;  // Free-stack links
+    std::atomic<uint64_t> head_;               // tag << 32 | index
+    std::atomic<size_t> available_;
+
+    static uint64_t pack(uint64_t tag, uint32_t index) {
+        return (tag << 32) | index;
+    }
+
+public:
+    // chunk_size is rounded up to a multiple of alignof(std::max_align_t)
+    ChunkPool(size_t chunk_size, uint32_t chunk_count)
+        : memory_(nullptr),
+          chunk_size_((chunk_size + alignof(std::max_align_t) - 1) &
+                      ~(alignof(std::max_align_t) - 1)),
+          chunk_count_(chunk_count == EMPTY ? EMPTY - 1 : chunk_count),
+          next_(new std::atomic<uint32_t>[chunk_count_]), head_(pack(0, EMPTY)),
+          available_(0) {
+        memory_ = static_cast<char*>(std::malloc(chunk_size_ * chunk_count_));
+        if (memory_ == nullptr || chunk_count_ == 0) {
+            return;
+        }
+        for (uint32_t i = 0; i < chunk_count_; ++i) {
+            next_[i].store(i + 1 < chunk_count_ ? i + 1 : EMPTY, std::memory_order_relaxed);
+        }
+        head_.store(pack(0, 0), std::memory_order_relaxed);
+        available_.store(chunk_count_, std::memory_order_relaxed);
+    }
+
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    ~ChunkPool() {
+        std::free(memory_);
+    }
+
+    // Pop a chunk, or nullptr when the pool is exhausted
+    void* acquire() {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t index = static_cast<uint32_t>(head);
+            if (index == EMPTY) {
+                return nullptr;
+            }
+            uint32_t next = next_[index].load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, pack((head >> 32) + 1, next),
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+                available_.fetch_sub(1, std::memory_order_relaxed);
+                return memory_ + static_cast<size_t>(index) * chunk_size_;
+            }
+        }
+    }
+
+    // Push a chunk previously returned by acquire()
+    void release(void* chunk) {
+        uint32_t index = static_cast<uint32_t>(
+            static_cast<size_t>(static_cast<char*>(chunk) - memory_) / chunk_size_);
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        do {
+            next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(head, pack((head >> 32) + 1, index),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+        available_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t chunk_size() const {
+        return chunk_size_;
+    }
+
+    // Method to get the start of the pooled memory; chunk i begins at
+    // data() + i * chunk_size(), or nullptr if allocation failed
+    char* data() const {
+        return memory_;
+    }
+
+    size_t chunk_count() const {
+        return chunk_count_;
+    }
+
+    // Method to get the number of chunks not held by any arena
+    size_t available() const {
+        return available_.load(std::memory_order_relaxed);
+    }
+};
+
+// Single-threaded bump arena that refills from a shared ChunkPool. Use one
+// per thread, typically through ThreadLocalArena::local(), so the hot path
+// never touches shared state.
+class ThreadLocalArena {
+private:
+    // Header at the start of every chunk held by this arena
+    struct alignas(std::max_align_t) Chunk {
+        Chunk* next;
+    };
+
+    ChunkPool& pool_;
+    Chunk* head_;              // Current chunk, older chunks chained behind it
+    char* next_;               // Bump pointer within the current chunk
+    char* end_;                // End of the current chunk
+    size_t allocations_;       // Counter for allocations
+    size_t padding_waste_;     // Bytes skipped to satisfy alignment
+
+    bool refill() {
+        void* raw = pool_.acquire();
+        if (raw == nullptr) {
+            return false;
+        }
+        Chunk* chunk = static_cast<Chunk*>(raw);
+        chunk->next = head_;
+        head_ = chunk;
+        next_ = reinterpret_cast<char*>(chunk + 1);
+        end_ = reinterpret_cast<char*>(chunk) + pool_.chunk_size();
+        return true;
+    }
+
+public:
+    explicit ThreadLocalArena(ChunkPool& pool)
+        : pool_(pool), head_(nullptr), next_(nullptr), end_(nullptr),
+          allocations_(0), padding_waste_(0) {}
+
+    ThreadLocalArena(const ThreadLocalArena&) = delete;
+    ThreadLocalArena& operator=(const ThreadLocalArena&) = delete;
+
+    ~ThreadLocalArena() {
+        reset();
+    }
+
+    // Arena owned by the calling thread. Each thread binds to the pool passed
+    // on its first call and every later call must pass that same pool; the
+    // pool must outlive every thread that uses it. Passing a different pool
+    // throws std::logic_error.
+    static ThreadLocalArena& local(ChunkPool& pool) {
+        thread_local ThreadLocalArena arena(pool);
+        if (&arena.pool() != &pool) {
+            throw std::logic_error("ThreadLocalArena::local() called with a second pool");
+        }
+        return arena;
+    }
+
+    // Method to get the pool this arena refills from
+    ChunkPool& pool() const {
+        return pool_;
+    }
+
+    template<typename T>
+    T* alloc(size_t n = 1) {
+        // Guard against sizeof(T) * n overflowing
+        if (n > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(alloc_aligned(sizeof(T) * n, alignof(T)));
+    }
+
+    // Allocations must fit in a single chunk (chunk_size minus its header)
+    void* alloc_aligned(size_t size, size_t align) {
+        if (align == 0 || (align & (align - 1)) != 0) {
+            return nullptr;
+        }
+
+        uintptr_t addr = reinterpret_cast<uintptr_t>(next_);
+        size_t padding = static_cast<size_t>(-addr) & (align - 1);
+        size_t remaining = remaining_space();
+        if (next_ == nullptr || padding > remaining || size > remaining - padding) {
+            size_t payload = pool_.chunk_size() > sizeof(Chunk)
+                                 ? pool_.chunk_size() - sizeof(Chunk)
+                                 : 0;
+            if (size > payload || align - 1 > payload - size || !refill()) {
+                return nullptr;
+            }
+            addr = reinterpret_cast<uintptr_t>(next_);
+            padding = static_cast<size_t>(-addr) & (align - 1);
+        }
+
+        char* result = next_ + padding;
+        next_ = result + size;
+        padding_waste_ += padding;
+        ++allocations_;
+
+        return result;
+    }
+
+    void dealloc() {
+        if (allocations_ > 0) {
+            --allocations_;
+
+            // If all allocations are freed, return every chunk to the pool
+            if (allocations_ == 0) {
+                reset();
+            }
+        }
+    }
+
+    // Drop all allocations and return every chunk to the pool
+    void reset() {
+        while (head_ != nullptr) {
+            Chunk* next = head_->next;
+            pool_.release(head_);
+            head_ = next;
+        }
+        next_ = nullptr;
+        end_ = nullptr;
+        allocations_ = 0;
+        padding_waste_ = 0;
+    }
+
+    // Method to get the number of chunks held by this arena
+    size_t chunk_count() const {
+        size_t count = 0;
+        for (Chunk* chunk = head_; chunk != nullptr; chunk = chunk->next) {
+            ++count;
+        }
+        return count;
+    }
+
+    size_t allocations() const {
+        return allocations_;
+    }
+
+    // Method to get remaining space in the current chunk
+    size_t remaining_space() const {
+        return static_cast<size_t>(end_ - next_);
+    }
+
+    size_t padding_waste() const {
+        return padding_waste_;
+    }
+};
+
+#endif // CONCURRENT_ARENA_HPP
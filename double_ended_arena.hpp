@@ -0,0 +1,213 @@
+#ifndef DOUBLE_ENDED_ARENA_HPP
+#define DOUBLE_ENDED_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "arena_storage.hpp"
+
+// Two bump allocators sharing one N-byte buffer: bottom() grows upward from
+// the start and top() grows downward from the end, and either fails only
+// when the two meet. Each end counts, marks, rewinds and resets on its own,
+// so long-lived data can sit at the bottom while per-frame temporaries are
+// cleared from the top.
+//
+// bottom() and top() present the same interface as a single-ended
+// allocator, so ArenaScope, BumpMemoryResource and PoolAllocator can be
+// used on either end.
+template<size_t N, template<size_t> class Storage = InlineStorage>
+class DoubleEndedArena : private BumpStorageHolder<Storage<N>> {
+public:
+    // Checkpoint returned by mark() and restored by rewind() on one end
+    struct Marker {
+        char* position;
+        size_t allocations;
+        size_t padding_waste;
+    };
+
+    template<bool Top>
+    class End {
+    private:
+        template<bool> friend class End;
+        friend class DoubleEndedArena;
+
+        DoubleEndedArena& arena_;
+        char* next_;               // Bump pointer for this end
+        size_t allocations_;
+        size_t padding_waste_;
+
+        explicit End(DoubleEndedArena& arena)
+            : arena_(arena), next_(base()), allocations_(0), padding_waste_(0) {}
+
+        char* base() const {
+            return Top ? arena_.memory_ + N : arena_.memory_;
+        }
+
+        // Bump pointer of the opposite end
+        char* limit() const {
+            return Top ? arena_.bottom_.next_ : arena_.top_.next_;
+        }
+
+    public:
+        using Marker = DoubleEndedArena::Marker;
+
+        End(const End&) = delete;
+        End& operator=(const End&) = delete;
+
+        template<typename T>
+        T* alloc(size_t n = 1) {
+            // Guard against sizeof(T) * n overflowing
+            if (n > SIZE_MAX / sizeof(T)) {
+                return nullptr;
+            }
+            return static_cast<T*>(alloc_aligned(sizeof(T) * n, alignof(T)));
+        }
+
+        void* alloc_aligned(size_t size, size_t align) {
+            if (align == 0 || (align & (align - 1)) != 0) {
+                return nullptr;
+            }
+
+            char* result;
+            if constexpr (Top) {
+                // Move down and round down to the alignment
+                if (size > static_cast<size_t>(next_ - limit())) {
+                    return nullptr;
+                }
+                uintptr_t addr = reinterpret_cast<uintptr_t>(next_ - size) & ~(uintptr_t(align) - 1);
+                if (addr < reinterpret_cast<uintptr_t>(limit())) {
+                    return nullptr;
+                }
+                result = reinterpret_cast<char*>(addr);
+                padding_waste_ += static_cast<size_t>(next_ - result) - size;
+                next_ = result;
+            } else {
+                // Round up to the alignment, then move up
+                uintptr_t addr = reinterpret_cast<uintptr_t>(next_);
+                size_t padding = static_cast<size_t>(-addr) & (align - 1);
+                size_t gap = static_cast<size_t>(limit() - next_);
+                if (padding > gap || size > gap - padding) {
+                    return nullptr;
+                }
+                result = next_ + padding;
+                padding_waste_ += padding;
+                next_ = result + size;
+            }
+
+            ++allocations_;
+            return result;
+        }
+
+        // Decrement this end's counter; the end resets when it reaches zero
+        void dealloc() {
+            if (allocations_ > 0) {
+                --allocations_;
+                if (allocations_ == 0) {
+                    next_ = base();
+                    padding_waste_ = 0;
+                }
+            }
+        }
+
+        // Drop every allocation on this end; the other end is untouched
+        void reset() {
+            next_ = base();
+            allocations_ = 0;
+            padding_waste_ = 0;
+        }
+
+        Marker mark() const {
+            return Marker{next_, allocations_, padding_waste_};
+        }
+
+        // Markers must be rewound in LIFO order per end
+        void rewind(const Marker& marker) {
+            next_ = marker.position;
+            allocations_ = marker.allocations;
+            padding_waste_ = marker.padding_waste;
+        }
+
+        // Method to get current number of allocations on this end
+        size_t allocations() const {
+            return allocations_;
+        }
+
+        // Method to get bytes this end has taken, including padding
+        size_t used() const {
+            return Top ? static_cast<size_t>(base() - next_) : static_cast<size_t>(next_ - base());
+        }
+
+        // Method to get the free gap between the two ends
+        size_t remaining_space() const {
+            return arena_.remaining_space();
+        }
+
+        // Method to get bytes lost to alignment padding on this end
+        size_t padding_waste() const {
+            return padding_waste_;
+        }
+    };
+
+    using Bottom = End<false>;
+    using Top = End<true>;
+
+private:
+    using Holder = BumpStorageHolder<Storage<N>>;
+
+    char* memory_;
+    Bottom bottom_;
+    Top top_;
+
+public:
+    DoubleEndedArena() : memory_(Holder::storage_.data()), bottom_(*this), top_(*this) {}
+
+    DoubleEndedArena(const DoubleEndedArena&) = delete;
+    DoubleEndedArena& operator=(const DoubleEndedArena&) = delete;
+
+    // Method to get the upward-growing end for long-lived data
+    Bottom& bottom() {
+        return bottom_;
+    }
+
+    const Bottom& bottom() const {
+        return bottom_;
+    }
+
+    // Method to get the downward-growing end for temporaries
+    Top& top() {
+        return top_;
+    }
+
+    const Top& top() const {
+        return top_;
+    }
+
+    // Drop both ends and let the storage release touched pages
+    void reset() {
+        Holder::storage_.discard(top_.used() > 0 ? N : bottom_.used());
+        bottom_.reset();
+        top_.reset();
+    }
+
+    // Static method to get the total capacity
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    // Method to get current number of allocations on both ends
+    size_t allocations() const {
+        return bottom_.allocations() + top_.allocations();
+    }
+
+    // Method to get the free gap between the two ends
+    size_t remaining_space() const {
+        return static_cast<size_t>(top_.next_ - bottom_.next_);
+    }
+
+    // Method to get bytes lost to alignment padding on both ends
+    size_t padding_waste() const {
+        return bottom_.padding_waste() + top_.padding_waste();
+    }
+};
+
+#endif // DOUBLE_ENDED_ARENA_HPP
@@ -0,0 +1,253 @@
+#ifndef FIBER_CONTEXT_HPP
+#define FIBER_CONTEXT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// x86-64 gets a hand-written switch; everything else, or any build defining
+// FIBER_CONTEXT_USE_UCONTEXT, falls back to ucontext. So do AddressSanitizer
+// builds, since ASan follows swapcontext but not an unannotated stack switch.
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) && !defined(FIBER_CONTEXT_USE_UCONTEXT)
+#define FIBER_CONTEXT_USE_UCONTEXT 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) && !defined(FIBER_CONTEXT_USE_UCONTEXT)
+#define FIBER_CONTEXT_USE_UCONTEXT 1
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(FIBER_CONTEXT_USE_UCONTEXT)
+#define FIBER_CONTEXT_ASM 1
+#include <cpuid.h>
+#else
+#include <ucontext.h>
+#endif
+
+// Saved execution state of a fiber, or of the thread that resumes fibers.
+// An entry function must never return; it finishes by switching away for
+// the last time.
+//
+// A switch is a function call, so the compiler already treats every
+// caller-saved register, including all vector registers, as clobbered. The
+// LITE mode therefore saves only what the SysV ABI requires a callee to
+// preserve: rbx, rbp, r12-r15, the MXCSR and the x87 control word. FULL
+// additionally saves the x87, SSE and AVX register files with xsave (fxsave
+// where xsave is unavailable), for code that keeps vector state live across
+// a switch behind the compiler's back. The mode belongs to the context
+// being switched away from. The ucontext fallback ignores it.
+class FiberContext {
+public:
+    enum class Mode {
+        LITE,
+        FULL
+    };
+
+private:
+    Mode mode_;
+
+#ifdef FIBER_CONTEXT_ASM
+    void* sp_;                 // Saved stack pointer; the frame tells how to resume
+
+    // Each switch pushes the callee-saved state, then the address of the
+    // code that restores it, saves rsp into *from and returns into the
+    // restore code at the top of the target stack
+    __attribute__((naked, noinline)) static void switch_lite(void** /*from*/, void* /*to*/) {
+        asm("pushq %rbp\n\t"
+            "pushq %rbx\n\t"
+            "pushq %r12\n\t"
+            "pushq %r13\n\t"
+            "pushq %r14\n\t"
+            "pushq %r15\n\t"
+            "subq $8, %rsp\n\t"
+            "stmxcsr (%rsp)\n\t"
+            "fnstcw 4(%rsp)\n\t"
+            "leaq 1f(%rip), %rax\n\t"
+            "pushq %rax\n\t"
+            "movq %rsp, (%rdi)\n\t"
+            "movq %rsi, %rsp\n\t"
+            "ret\n"
+            "1:\n\t"
+            "ldmxcsr (%rsp)\n\t"
+            "fldcw 4(%rsp)\n\t"
+            "addq $8, %rsp\n\t"
+            "popq %r15\n\t"
+            "popq %r14\n\t"
+            "popq %r13\n\t"
+            "popq %r12\n\t"
+            "popq %rbx\n\t"
+            "popq %rbp\n\t"
+            "ret");
+    }
+
+    // xsave of x87, SSE and AVX (component mask 7) into a 64-byte aligned
+    // area below the saved registers, with the header zeroed for xrstor
+    __attribute__((naked, noinline)) static void switch_xsave(void** /*from*/, void* /*to*/) {
+        asm("pushq %rbp\n\t"
+            "pushq %rbx\n\t"
+            "pushq %r12\n\t"
+            "pushq %r13\n\t"
+            "pushq %r14\n\t"
+            "pushq %r15\n\t"
+            "movq %rsp, %r11\n\t"
+            "subq $1088, %rsp\n\t"
+            "andq $-64, %rsp\n\t"
+            "movq %r11, 1024(%rsp)\n\t"
+            "xorl %eax, %eax\n\t"
+            "movq %rax, 512(%rsp)\n\t"
+            "movq %rax, 520(%rsp)\n\t"
+            "movq %rax, 528(%rsp)\n\t"
+            "movq %rax, 536(%rsp)\n\t"
+            "movq %rax, 544(%rsp)\n\t"
+            "movq %rax, 552(%rsp)\n\t"
+            "movq %rax, 560(%rsp)\n\t"
+            "movq %rax, 568(%rsp)\n\t"
+            "movl $7, %eax\n\t"
+            "xorl %edx, %edx\n\t"
+            "xsave64 (%rsp)\n\t"
+            "leaq 1f(%rip), %rax\n\t"
+            "pushq %rax\n\t"
+            "movq %rsp, (%rdi)\n\t"
+            "movq %rsi, %rsp\n\t"
+            "ret\n"
+            "1:\n\t"
+            "movl $7, %eax\n\t"
+            "xorl %edx, %edx\n\t"
+            "xrstor64 (%rsp)\n\t"
+            "movq 1024(%rsp), %rsp\n\t"
+            "popq %r15\n\t"
+            "popq %r14\n\t"
+            "popq %r13\n\t"
+            "popq %r12\n\t"
+            "popq %rbx\n\t"
+            "popq %rbp\n\t"
+            "ret");
+    }
+
+    __attribute__((naked, noinline)) static void switch_fxsave(void** /*from*/, void* /*to*/) {
+        asm("pushq %rbp\n\t"
+            "pushq %rbx\n\t"
+            "pushq %r12\n\t"
+            "pushq %r13\n\t"
+            "pushq %r14\n\t"
+            "pushq %r15\n\t"
+            "movq %rsp, %r11\n\t"
+            "subq $528, %rsp\n\t"
+            "andq $-16, %rsp\n\t"
+            "movq %r11, 512(%rsp)\n\t"
+            "fxsave64 (%rsp)\n\t"
+            "leaq 1f(%rip), %rax\n\t"
+            "pushq %rax\n\t"
+            "movq %rsp, (%rdi)\n\t"
+            "movq %rsi, %rsp\n\t"
+            "ret\n"
+            "1:\n\t"
+            "fxrstor64 (%rsp)\n\t"
+            "movq 512(%rsp), %rsp\n\t"
+            "popq %r15\n\t"
+            "popq %r14\n\t"
+            "popq %r13\n\t"
+            "popq %r12\n\t"
+            "popq %rbx\n\t"
+            "popq %rbp\n\t"
+            "ret");
+    }
+
+    // First resume of a new context: entry and arg sit above the return
+    // slot, and popping them leaves rsp 16-byte aligned for the call
+    __attribute__((naked, noinline)) static void start() {
+        asm("popq %rax\n\t"
+            "popq %rdi\n\t"
+            "callq *%rax\n\t"
+            "ud2");
+    }
+
+    static bool has_xsave() {
+        static const bool supported = [] {
+            unsigned eax, ebx, ecx, edx;
+            return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_OSXSAVE) != 0;
+        }();
+        return supported;
+    }
+#else
+    ucontext_t context_;
+
+    struct Start {
+        void (*entry)(void*);
+        void* arg;
+    };
+
+    // makecontext only passes ints, so the Start pointer is split in two
+    static void trampoline(unsigned high, unsigned low) {
+        Start* start = reinterpret_cast<Start*>((static_cast<uintptr_t>(high) << 32) |
+                                                static_cast<uintptr_t>(low));
+        start->entry(start->arg);
+    }
+
+    Start start_;
+#endif
+
+public:
+#ifdef FIBER_CONTEXT_ASM
+    explicit FiberContext(Mode mode = Mode::LITE) : mode_(mode), sp_(nullptr) {}
+#else
+    explicit FiberContext(Mode mode = Mode::LITE) : mode_(mode), context_(), start_{nullptr, nullptr} {}
+#endif
+
+    FiberContext(const FiberContext&) = delete;
+    FiberContext& operator=(const FiberContext&) = delete;
+
+    // Prepare entry(arg) to run on [stack, stack + size) on the first swap
+    // to this context. Returns false if the context cannot be created.
+    bool make(char* stack, size_t size, void (*entry)(void*), void* arg) {
+#ifdef FIBER_CONTEXT_ASM
+        if (size < 64) {
+            return false;
+        }
+        uintptr_t top = (reinterpret_cast<uintptr_t>(stack) + size) & ~uintptr_t(15);
+        void** frame = reinterpret_cast<void**>(top - 40);
+        frame[0] = reinterpret_cast<void*>(&FiberContext::start);
+        frame[1] = reinterpret_cast<void*>(entry);
+        frame[2] = arg;
+        sp_ = frame;
+        return true;
+#else
+        if (getcontext(&context_) != 0) {
+            return false;
+        }
+        start_ = Start{entry, arg};
+        context_.uc_stack.ss_sp = stack;
+        context_.uc_stack.ss_size = size;
+        context_.uc_link = nullptr;
+        uintptr_t start = reinterpret_cast<uintptr_t>(&start_);
+        makecontext(&context_, reinterpret_cast<void (*)()>(trampoline), 2,
+                    static_cast<unsigned>(start >> 32), static_cast<unsigned>(start & 0xffffffffu));
+        return true;
+#endif
+    }
+
+    // Save the running state into `from` and resume `to`
+    static void swap(FiberContext& from, FiberContext& to) {
+#ifdef FIBER_CONTEXT_ASM
+        if (from.mode_ == Mode::LITE) {
+            switch_lite(&from.sp_, to.sp_);
+        } else if (has_xsave()) {
+            switch_xsave(&from.sp_, to.sp_);
+        } else {
+            switch_fxsave(&from.sp_, to.sp_);
+        }
+#else
+        swapcontext(&from.context_, &to.context_);
+#endif
+    }
+
+    // Method to get what a switch away from this context saves
+    Mode mode() const {
+        return mode_;
+    }
+
+    void set_mode(Mode mode) {
+        mode_ = mode;
+    }
+};
+
+#endif // FIBER_CONTEXT_HPP
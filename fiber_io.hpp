@@ -0,0 +1,656 @@
+#ifndef FIBER_IO_HPP
+#define FIBER_IO_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+
+#include "concurrent_arena.hpp"
+#include "fiber_scheduler.hpp"
+
+#if defined(ARENA_STORAGE_HAS_MMAP) && defined(__linux__)
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+// linux/io_uring.h drags in linux/fs.h, whose BLOCK_SIZE macro would leak
+// into every includer
+#ifndef BLOCK_SIZE
+#define FIBER_IO_UNDEF_BLOCK_SIZE
+#endif
+#include <linux/io_uring.h>
+#ifdef FIBER_IO_UNDEF_BLOCK_SIZE
+#undef BLOCK_SIZE
+#undef BLOCK_SIZE_BITS
+#undef FIBER_IO_UNDEF_BLOCK_SIZE
+#endif
+#define FIBER_IO_HAS_IO_URING 1
+#endif
+
+// I/O reactor for fibers on a FiberScheduler. read(), write(), accept() and
+// wait() called from a fiber park it until the operation completes, while
+// the worker runs other fibers; called from any other thread they block
+// like the plain syscalls.
+//
+// The reactor attaches itself as the scheduler's FiberPoller. Parked
+// operations are queued and submitted together on the next scheduler tick,
+// so a burst of fibers hitting I/O costs one io_uring_enter (or one
+// epoll_wait after its epoll_ctl calls) rather than a syscall each.
+//
+// With io_uring (raw syscalls, no liburing), operations are submitted
+// directly and the buffer pool is registered with the ring, so reads and
+// writes inside acquire_buffer() memory use the fixed-buffer opcodes. The
+// epoll fallback retries each operation when its fd becomes ready; fds must
+// be non-blocking there, and only one fiber may wait on a given fd at once.
+//
+// Destroy the reactor only once no fiber is parked on it, typically after
+// the scheduler's wait().
+class FiberReactor : public FiberPoller {
+public:
+    enum class Backend {
+        AUTO,                  // io_uring when the kernel supports it, else epoll
+        IO_URING,
+        EPOLL
+    };
+
+private:
+    enum class Op : uint8_t {
+        READ,
+        WRITE,
+        ACCEPT,
+        WAIT
+    };
+
+    // One parked operation; lives on the parked fiber's stack
+    struct Request {
+        FiberReactor* reactor;
+        FiberScheduler::Handle fiber;
+        Request* next;
+        Op op;
+        int fd;
+        void* buf;
+        size_t len;
+        sockaddr* addr;
+        socklen_t* addrlen;
+        uint32_t events;       // Poll events to wait for
+        int result;            // Syscall result, or -errno
+    };
+
+    // Linux never transfers more than this in one read or write
+    static constexpr size_t MAX_IO = 0x7ffff000;
+    static constexpr int MAX_EVENTS = 64;
+
+    FiberScheduler& scheduler_;
+    Backend backend_;
+    ChunkPool buffers_;
+    int event_fd_;             // Written by interrupt()
+    int epoll_fd_;
+
+    std::mutex poll_mutex_;    // One thread at a time submits and reaps
+    std::mutex pending_mutex_;
+    Request* pending_;         // Parked, not yet submitted
+    std::atomic<size_t> pending_count_;
+    std::atomic<size_t> in_flight_;  // Submitted, not yet completed
+    std::atomic<bool> blocked_;      // A poll() is waiting in the kernel
+    std::atomic<size_t> batches_;
+    std::atomic<size_t> submitted_;
+
+#ifdef FIBER_IO_HAS_IO_URING
+    struct Ring {
+        int fd;
+        unsigned entries;
+        void* map;             // SQ and CQ rings share one mapping
+        size_t map_size;
+        io_uring_sqe* sqes;
+        size_t sqes_size;
+        unsigned* sq_head;
+        unsigned* sq_tail;
+        unsigned* sq_mask;
+        unsigned* sq_array;
+        unsigned* cq_head;
+        unsigned* cq_tail;
+        unsigned* cq_mask;
+        io_uring_cqe* cqes;
+        unsigned local_tail;   // SQ entries filled so far
+    };
+
+    Ring ring_;
+    bool fixed_buffers_;       // The buffer pool is registered with the ring
+    bool event_armed_;         // A read of event_fd_ is in flight
+    uint64_t event_value_;
+
+    bool setup_ring(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return false;
+        }
+        // Timed waits need EXT_ARG; NODROP keeps completions past a full CQ
+        unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+        if ((params.features & required) != required) {
+            close(fd);
+            return false;
+        }
+
+        size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        size_t map_size = std::max(sq_size, cq_size);
+        void* map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                         IORING_OFF_SQ_RING);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        size_t sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                          IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            munmap(map, map_size);
+            close(fd);
+            return false;
+        }
+
+        char* base = static_cast<char*>(map);
+        ring_.fd = fd;
+        ring_.entries = params.sq_entries;
+        ring_.map = map;
+        ring_.map_size = map_size;
+        ring_.sqes = static_cast<io_uring_sqe*>(sqes);
+        ring_.sqes_size = sqes_size;
+        ring_.sq_head = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+        ring_.sq_tail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        ring_.sq_mask = reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        ring_.sq_array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        ring_.cq_head = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        ring_.cq_tail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        ring_.cq_mask = reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        ring_.cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+        ring_.local_tail = *ring_.sq_tail;
+
+        // Pin the buffer pool so reads and writes into it skip the page walk
+        if (buffers_.data() != nullptr) {
+            iovec region{buffers_.data(), buffers_.chunk_size() * buffers_.chunk_count()};
+            fixed_buffers_ = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, &region, 1) == 0;
+        }
+        return true;
+    }
+
+    void teardown_ring() {
+        munmap(ring_.sqes, ring_.sqes_size);
+        munmap(ring_.map, ring_.map_size);
+        close(ring_.fd);
+    }
+
+    // Next free submission entry, or nullptr when the SQ is full
+    io_uring_sqe* next_sqe() {
+        unsigned head = __atomic_load_n(ring_.sq_head, __ATOMIC_ACQUIRE);
+        if (ring_.local_tail - head >= ring_.entries) {
+            return nullptr;
+        }
+        unsigned index = ring_.local_tail & *ring_.sq_mask;
+        ring_.sq_array[index] = index;
+        ++ring_.local_tail;
+        io_uring_sqe* sqe = &ring_.sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    void prepare(io_uring_sqe* sqe, Request* request) {
+        sqe->fd = request->fd;
+        sqe->user_data = reinterpret_cast<uintptr_t>(request);
+        switch (request->op) {
+        case Op::READ:
+        case Op::WRITE: {
+            bool fixed = fixed_buffers_ && in_buffers(request->buf, request->len);
+            if (request->op == Op::READ) {
+                sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            } else {
+                sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+            }
+            sqe->addr = reinterpret_cast<uintptr_t>(request->buf);
+            sqe->len = static_cast<uint32_t>(request->len);
+            sqe->off = static_cast<uint64_t>(-1);  // Current file position
+            sqe->buf_index = 0;
+            break;
+        }
+        case Op::ACCEPT:
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->addr = reinterpret_cast<uintptr_t>(request->addr);
+            sqe->addr2 = reinterpret_cast<uintptr_t>(request->addrlen);
+            break;
+        case Op::WAIT:
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->poll32_events = request->events;
+            break;
+        }
+    }
+
+    // Completions are reaped from shared memory without a syscall
+    size_t reap_ring() {
+        size_t resumed = 0;
+        unsigned head = *ring_.cq_head;
+        unsigned tail = __atomic_load_n(ring_.cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            io_uring_cqe* cqe = &ring_.cqes[head & *ring_.cq_mask];
+            uint64_t data = cqe->user_data;
+            int result = cqe->res;
+            ++head;
+            if (data == 0) {
+                event_armed_ = false;
+                continue;
+            }
+            Request* request = reinterpret_cast<Request*>(static_cast<uintptr_t>(data));
+            request->result = result;
+            in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            scheduler_.resume(request->fiber);
+            ++resumed;
+        }
+        __atomic_store_n(ring_.cq_head, head, __ATOMIC_RELEASE);
+        return resumed;
+    }
+
+    size_t poll_ring(Request* batch, int timeout_ms) {
+        if (!event_armed_) {
+            if (io_uring_sqe* sqe = next_sqe()) {
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = event_fd_;
+                sqe->addr = reinterpret_cast<uintptr_t>(&event_value_);
+                sqe->len = sizeof(event_value_);
+                sqe->off = static_cast<uint64_t>(-1);
+                sqe->user_data = 0;
+                event_armed_ = true;
+            }
+        }
+
+        size_t queued = 0;
+        while (batch != nullptr) {
+            io_uring_sqe* sqe = next_sqe();
+            if (sqe == nullptr) {
+                // SQ full: the rest go out on the next tick
+                requeue(batch);
+                break;
+            }
+            Request* next = batch->next;
+            prepare(sqe, batch);
+            batch = next;
+            ++queued;
+        }
+        __atomic_store_n(ring_.sq_tail, ring_.local_tail, __ATOMIC_RELEASE);
+        if (queued > 0) {
+            in_flight_.fetch_add(queued, std::memory_order_relaxed);
+            submitted_.fetch_add(queued, std::memory_order_relaxed);
+            batches_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        unsigned to_submit = ring_.local_tail - __atomic_load_n(ring_.sq_head, __ATOMIC_ACQUIRE);
+        bool wait = timeout_ms > 0 && reap_ready() == 0 && !interrupted_by_pending();
+        if (to_submit > 0 || wait) {
+            __kernel_timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000LL};
+            io_uring_getevents_arg arg;
+            std::memset(&arg, 0, sizeof(arg));
+            arg.ts = reinterpret_cast<uintptr_t>(&timeout);
+            unsigned flags = wait ? IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG : 0;
+            syscall(__NR_io_uring_enter, ring_.fd, to_submit, wait ? 1u : 0u, flags,
+                    wait ? &arg : nullptr, wait ? sizeof(arg) : 0);
+            blocked_.store(false, std::memory_order_release);
+        }
+        return reap_ring();
+    }
+
+    // Completions already posted but not yet reaped
+    unsigned reap_ready() const {
+        return __atomic_load_n(ring_.cq_tail, __ATOMIC_ACQUIRE) - *ring_.cq_head;
+    }
+#endif
+
+    bool in_buffers(const void* ptr, size_t len) const {
+        const char* begin = buffers_.data();
+        const char* p = static_cast<const char*>(ptr);
+        size_t total = buffers_.chunk_size() * buffers_.chunk_count();
+        return begin != nullptr && p >= begin && len <= total &&
+               static_cast<size_t>(p - begin) <= total - len;
+    }
+
+    // Announce a blocking wait; false if parked work arrived in the
+    // meantime, which the queueing side will not interrupt us for
+    bool interrupted_by_pending() {
+        blocked_.store(true, std::memory_order_seq_cst);
+        if (pending_count_.load(std::memory_order_seq_cst) > 0) {
+            blocked_.store(false, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    Request* take_pending() {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        Request* batch = pending_;
+        pending_ = nullptr;
+        pending_count_.store(0, std::memory_order_relaxed);
+        return batch;
+    }
+
+    void requeue(Request* batch) {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        while (batch != nullptr) {
+            Request* next = batch->next;
+            batch->next = pending_;
+            pending_ = batch;
+            pending_count_.fetch_add(1, std::memory_order_relaxed);
+            batch = next;
+        }
+    }
+
+    // Runs on the worker once the parking fiber is off its stack
+    static void queue(FiberScheduler::Handle fiber, void* arg) {
+        Request* request = static_cast<Request*>(arg);
+        FiberReactor& reactor = *request->reactor;
+        request->fiber = fiber;
+        {
+            std::lock_guard<std::mutex> lock(reactor.pending_mutex_);
+            request->next = reactor.pending_;
+            reactor.pending_ = request;
+        }
+        reactor.pending_count_.fetch_add(1, std::memory_order_seq_cst);
+        // A poller asleep in the kernel would not submit it until its timeout
+        if (reactor.blocked_.load(std::memory_order_seq_cst)) {
+            reactor.interrupt();
+        }
+    }
+
+    int park_on(Request& request) {
+        request.reactor = this;
+        request.result = 0;
+        FiberScheduler::park(&FiberReactor::queue, &request);
+        return request.result;
+    }
+
+    size_t poll_epoll(Request* batch, int timeout_ms) {
+        size_t resumed = 0;
+        size_t armed = 0;
+        while (batch != nullptr) {
+            Request* next = batch->next;
+            epoll_event event;
+            event.events = batch->events | EPOLLONESHOT;
+            event.data.ptr = batch;
+            int result = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, batch->fd, &event);
+            if (result != 0 && errno == ENOENT) {
+                result = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, batch->fd, &event);
+            }
+            if (result != 0) {
+                batch->result = -errno;
+                scheduler_.resume(batch->fiber);
+                ++resumed;
+            } else {
+                ++armed;
+            }
+            batch = next;
+        }
+        if (armed > 0) {
+            in_flight_.fetch_add(armed, std::memory_order_relaxed);
+            submitted_.fetch_add(armed, std::memory_order_relaxed);
+            batches_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (timeout_ms > 0 && interrupted_by_pending()) {
+            timeout_ms = 0;
+        }
+        if (timeout_ms == 0 && in_flight_.load(std::memory_order_relaxed) == 0) {
+            return resumed;
+        }
+        epoll_event events[MAX_EVENTS];
+        int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+        blocked_.store(false, std::memory_order_release);
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                uint64_t value;
+                ssize_t drained = ::read(event_fd_, &value, sizeof(value));
+                (void)drained;
+                continue;
+            }
+            Request* request = static_cast<Request*>(events[i].data.ptr);
+            request->result = static_cast<int>(events[i].events);
+            in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            scheduler_.resume(request->fiber);
+            ++resumed;
+        }
+        return resumed;
+    }
+
+    static ssize_t direct(Op op, int fd, void* buf, size_t len, sockaddr* addr, socklen_t* addrlen) {
+        switch (op) {
+        case Op::READ:
+            return ::read(fd, buf, len);
+        case Op::WRITE:
+            return ::write(fd, buf, len);
+        case Op::ACCEPT:
+            return ::accept(fd, addr, addrlen);
+        case Op::WAIT:
+            break;
+        }
+        return -1;
+    }
+
+    ssize_t io(Op op, int fd, void* buf, size_t len, sockaddr* addr, socklen_t* addrlen, uint32_t events) {
+        len = std::min(len, MAX_IO);
+        if (!FiberScheduler::in_fiber()) {
+            return direct(op, fd, buf, len, addr, addrlen);
+        }
+#ifdef FIBER_IO_HAS_IO_URING
+        if (backend_ == Backend::IO_URING) {
+            while (true) {
+                Request request{};
+                request.op = op;
+                request.fd = fd;
+                request.buf = buf;
+                request.len = len;
+                request.addr = addr;
+                request.addrlen = addrlen;
+                int result = park_on(request);
+                // Non-blocking fds report EAGAIN instead of waiting
+                if (result == -EAGAIN) {
+                    if (wait(fd, events) < 0) {
+                        return -1;
+                    }
+                    continue;
+                }
+                if (result < 0) {
+                    errno = -result;
+                    return -1;
+                }
+                return result;
+            }
+        }
+#endif
+        while (true) {
+            ssize_t result = direct(op, fd, buf, len, addr, addrlen);
+            if (result >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                return result;
+            }
+            if (wait(fd, events) < 0) {
+                return -1;
+            }
+        }
+    }
+
+public:
+    // buffer_count buffers of buffer_size bytes make up the registered
+    // pool. Backend::IO_URING throws std::system_error where io_uring is
+    // unavailable; AUTO falls back to epoll.
+    explicit FiberReactor(FiberScheduler& scheduler, size_t buffer_size = 16 * 1024,
+                          uint32_t buffer_count = 64, Backend backend = Backend::AUTO,
+                          unsigned ring_entries = 256)
+        : scheduler_(scheduler), backend_(Backend::EPOLL), buffers_(buffer_size, buffer_count),
+          event_fd_(-1), epoll_fd_(-1), pending_(nullptr), pending_count_(0), in_flight_(0),
+          blocked_(false), batches_(0), submitted_(0) {
+        event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (event_fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "eventfd");
+        }
+#ifdef FIBER_IO_HAS_IO_URING
+        fixed_buffers_ = false;
+        event_armed_ = false;
+        event_value_ = 0;
+        if (backend != Backend::EPOLL && setup_ring(ring_entries)) {
+            backend_ = Backend::IO_URING;
+        }
+#else
+        (void)ring_entries;
+#endif
+        if (backend_ != Backend::IO_URING) {
+            if (backend == Backend::IO_URING) {
+                close(event_fd_);
+                throw std::system_error(ENOSYS, std::generic_category(), "io_uring");
+            }
+            epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = nullptr;
+            if (epoll_fd_ < 0 || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event) != 0) {
+                int error = errno;
+                if (epoll_fd_ >= 0) {
+                    close(epoll_fd_);
+                }
+                close(event_fd_);
+                throw std::system_error(error, std::generic_category(), "epoll");
+            }
+        }
+        scheduler_.set_poller(this);
+    }
+
+    FiberReactor(const FiberReactor&) = delete;
+    FiberReactor& operator=(const FiberReactor&) = delete;
+
+    ~FiberReactor() override {
+        scheduler_.set_poller(nullptr);
+#ifdef FIBER_IO_HAS_IO_URING
+        if (backend_ == Backend::IO_URING) {
+            teardown_ring();
+        }
+#endif
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+        close(event_fd_);
+    }
+
+    // Read up to count bytes, parking the calling fiber until data arrives.
+    // Returns like ::read(), with errno set on failure.
+    ssize_t read(int fd, void* buf, size_t count) {
+        return io(Op::READ, fd, buf, count, nullptr, nullptr, POLLIN);
+    }
+
+    // Write up to count bytes, parking the calling fiber until there is room
+    ssize_t write(int fd, const void* buf, size_t count) {
+        return io(Op::WRITE, fd, const_cast<void*>(buf), count, nullptr, nullptr, POLLOUT);
+    }
+
+    // Accept a connection on a listening socket, parking until one arrives
+    int accept(int fd, sockaddr* addr = nullptr, socklen_t* addrlen = nullptr) {
+        return static_cast<int>(io(Op::ACCEPT, fd, nullptr, 0, addr, addrlen, POLLIN));
+    }
+
+    // Park until fd is ready for events (POLLIN, POLLOUT). Returns the
+    // ready events, or -1 with errno set.
+    int wait(int fd, uint32_t events) {
+        if (!FiberScheduler::in_fiber()) {
+            pollfd entry{fd, static_cast<short>(events), 0};
+            return ::poll(&entry, 1, -1) < 0 ? -1 : entry.revents;
+        }
+        Request request{};
+        request.op = Op::WAIT;
+        request.fd = fd;
+        request.events = events;
+        int result = park_on(request);
+        if (result < 0) {
+            errno = -result;
+            return -1;
+        }
+        return result;
+    }
+
+    // Buffer of buffer_size() bytes from the registered pool, or nullptr
+    // when all are in use. Safe from any thread.
+    char* acquire_buffer() {
+        return static_cast<char*>(buffers_.acquire());
+    }
+
+    void release_buffer(char* buffer) {
+        buffers_.release(buffer);
+    }
+
+    size_t poll(int timeout_ms) override {
+        if (timeout_ms == 0 && pending_count_.load(std::memory_order_acquire) == 0 &&
+            in_flight_.load(std::memory_order_acquire) == 0) {
+            return 0;
+        }
+        std::unique_lock<std::mutex> lock(poll_mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return 0;
+        }
+        Request* batch = take_pending();
+#ifdef FIBER_IO_HAS_IO_URING
+        if (backend_ == Backend::IO_URING) {
+            return poll_ring(batch, timeout_ms);
+        }
+#endif
+        return poll_epoll(batch, timeout_ms);
+    }
+
+    void interrupt() override {
+        uint64_t one = 1;
+        ssize_t written = ::write(event_fd_, &one, sizeof(one));
+        (void)written;
+    }
+
+    // Method to get the backend in use
+    Backend backend() const {
+        return backend_;
+    }
+
+    // Method to check whether the buffer pool is registered for fixed I/O
+    bool fixed_buffers() const {
+#ifdef FIBER_IO_HAS_IO_URING
+        return fixed_buffers_;
+#else
+        return false;
+#endif
+    }
+
+    // Method to get the bytes per pooled buffer
+    size_t buffer_size() const {
+        return buffers_.chunk_size();
+    }
+
+    // Method to get the number of operations submitted to the kernel
+    size_t submitted() const {
+        return submitted_.load(std::memory_order_relaxed);
+    }
+
+    // Method to get the number of ticks that submitted at least one operation
+    size_t batches() const {
+        return batches_.load(std::memory_order_relaxed);
+    }
+
+    // Method to get the number of submitted operations not yet completed
+    size_t in_flight() const {
+        return in_flight_.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // ARENA_STORAGE_HAS_MMAP && __linux__
+
+#endif // FIBER_IO_HPP
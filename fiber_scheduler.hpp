@@ -0,0 +1,486 @@
+#ifndef FIBER_SCHEDULER_HPP
+#define FIBER_SCHEDULER_HPP
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fiber_context.hpp"
+#include "fiber_stack.hpp"
+#include "task1.hpp"
+#include "work_stealing_deque.hpp"
+
+#ifdef ARENA_STORAGE_HAS_MMAP
+
+// Event source that scheduler workers drive between fibers, such as the I/O
+// reactor in fiber_io.hpp. Workers call poll(0) every few dozen fibers and
+// whenever they run out of work, and one idle worker at a time blocks in
+// poll() instead of sleeping. Implementations resume the fibers whose events
+// completed and must tolerate poll() being called from any worker.
+class FiberPoller {
+public:
+    virtual ~FiberPoller() = default;
+
+    // Submit queued work and resume completed fibers, waiting up to
+    // timeout_ms for something to happen. Returns the fibers resumed.
+    virtual size_t poll(int timeout_ms) = 0;
+
+    // Make a blocked poll() return early; callable from any thread
+    virtual void interrupt() = 0;
+};
+
+// M:N fiber scheduler: fibers run on a fixed set of worker threads, each
+// with its own Chase-Lev deque. A worker pops its own deque LIFO, then takes
+// fibers spawned from outside the scheduler, then resumes its yielded fibers
+// oldest first, then steals FIFO from randomly chosen victims. Idle workers
+// sleep until something becomes runnable.
+//
+// Fiber stacks come from one FiberStackPool and the fiber's bookkeeping
+// sits at the top of its own stack, so spawn() costs one pool pop and no
+// heap allocation beyond what std::function needs for the captures.
+//
+// Every worker owns a BumpArena handed out through scratch() for
+// fiber-local temporaries. The arena is reset each time a fiber gives the
+// worker back, whether it yielded or finished, so scratch memory is valid
+// until the calling fiber next yields. Fibers migrate between workers, so
+// nothing taken from scratch() may be held across yield().
+//
+// park() suspends a fiber until someone passes its handle to resume(),
+// which is how a FiberPoller attached with set_poller() blocks fibers on I/O.
+class FiberScheduler {
+private:
+    struct Worker;
+
+    struct Fiber {
+        FiberContext context;
+        FiberStack stack;
+        std::function<void()> func;
+        bool finished;
+        void (*on_parked)(Fiber*, void*);  // Set while the fiber is parking
+        void* park_arg;
+
+        Fiber(FiberStack fiber_stack, std::function<void()>&& fiber_func, FiberContext::Mode mode)
+            : context(mode), stack(fiber_stack), func(std::move(fiber_func)), finished(false),
+              on_parked(nullptr), park_arg(nullptr) {}
+    };
+
+    // Fibers run between two non-blocking polls of the poller
+    static constexpr size_t POLL_INTERVAL = 64;
+
+    struct alignas(64) Worker {
+        FiberScheduler* scheduler;
+        size_t index;
+        WorkStealingDeque<Fiber> deque;
+        WorkStealingDeque<Fiber> yielded;  // Taken from the top only, so FIFO
+        FiberContext context;      // Worker loop, resumed when a fiber yields
+        Fiber* current;            // Fiber running on this worker, if any
+        BumpArena scratch;
+        uint64_t rng;              // xorshift state for picking victims
+        size_t ticks;              // Loop iterations, for pacing polls
+        std::atomic<size_t> steals;
+        std::thread thread;
+
+        Worker(FiberScheduler* owner, size_t worker_index, size_t scratch_size)
+            : scheduler(owner), index(worker_index), current(nullptr), scratch(scratch_size),
+              rng(0x9E3779B97F4A7C15ull * (worker_index + 1)), ticks(0), steals(0) {}
+    };
+
+    static inline thread_local Worker* current_worker_ = nullptr;
+
+    FiberStackPool stacks_;
+    std::mutex stacks_mutex_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex inject_mutex_;  // Fibers spawned from outside, or overflowing a deque
+    std::deque<Fiber*> inject_;
+    std::atomic<size_t> injected_;
+
+    std::atomic<size_t> runnable_;  // Fibers sitting in a deque or the inject queue
+    std::atomic<size_t> sleepers_;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+
+    std::atomic<size_t> live_;      // Spawned fibers that have not finished
+    std::mutex done_mutex_;
+    std::condition_variable done_cv_;
+
+    std::atomic<FiberPoller*> poller_;
+    std::atomic<size_t> poller_users_;  // Workers inside the poller; detach waits for them
+    std::atomic<bool> blocking_poll_;   // An idle worker is waiting in poll()
+
+    std::atomic<bool> stopping_;
+
+    // Fibers move between threads, so the thread-local is read through an
+    // opaque call rather than letting the compiler cache its address across
+    // a context switch
+    __attribute__((noinline)) static Worker* current_worker() {
+        Worker* worker = current_worker_;
+        asm volatile("" : "+r"(worker) : : "memory");
+        return worker;
+    }
+
+    static void entry(void* arg) {
+        Fiber* fiber = static_cast<Fiber*>(arg);
+        try {
+            fiber->func();
+        } catch (...) {
+            // Nothing above the entry point can catch it
+            std::terminate();
+        }
+        // Run the captures' destructors while still on the fiber's stack
+        fiber->func = nullptr;
+        fiber->finished = true;
+        FiberContext::swap(fiber->context, current_worker()->context);
+    }
+
+    size_t poll(int timeout_ms) {
+        if (poller_.load(std::memory_order_relaxed) == nullptr) {
+            return 0;
+        }
+        poller_users_.fetch_add(1, std::memory_order_seq_cst);
+        FiberPoller* poller = poller_.load(std::memory_order_seq_cst);
+        size_t resumed = poller != nullptr ? poller->poll(timeout_ms) : 0;
+        poller_users_.fetch_sub(1, std::memory_order_release);
+        return resumed;
+    }
+
+    void interrupt_poller() {
+        poller_users_.fetch_add(1, std::memory_order_seq_cst);
+        if (FiberPoller* poller = poller_.load(std::memory_order_seq_cst)) {
+            poller->interrupt();
+        }
+        poller_users_.fetch_sub(1, std::memory_order_release);
+    }
+
+    void wake_one() {
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            idle_cv_.notify_one();
+        } else if (blocking_poll_.load(std::memory_order_seq_cst)) {
+            interrupt_poller();
+        }
+    }
+
+    void enqueue(Fiber* fiber, bool yielded = false) {
+        runnable_.fetch_add(1, std::memory_order_seq_cst);
+        Worker* worker = current_worker();
+        if (worker == nullptr || worker->scheduler != this ||
+            !(yielded ? worker->yielded : worker->deque).push(fiber)) {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            inject_.push_back(fiber);
+            injected_.fetch_add(1, std::memory_order_release);
+        }
+        wake_one();
+    }
+
+    Fiber* take_injected() {
+        if (injected_.load(std::memory_order_acquire) == 0) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (inject_.empty()) {
+            return nullptr;
+        }
+        Fiber* fiber = inject_.front();
+        inject_.pop_front();
+        injected_.fetch_sub(1, std::memory_order_relaxed);
+        return fiber;
+    }
+
+    Fiber* steal(Worker& thief) {
+        size_t count = workers_.size();
+        if (count < 2) {
+            return nullptr;
+        }
+        thief.rng ^= thief.rng << 13;
+        thief.rng ^= thief.rng >> 7;
+        thief.rng ^= thief.rng << 17;
+        size_t start = static_cast<size_t>(thief.rng % count);
+        for (size_t i = 0; i < count; ++i) {
+            Worker& victim = *workers_[(start + i) % count];
+            if (&victim == &thief) {
+                continue;
+            }
+            Fiber* fiber = victim.deque.steal();
+            if (fiber == nullptr) {
+                fiber = victim.yielded.steal();
+            }
+            if (fiber != nullptr) {
+                thief.steals.fetch_add(1, std::memory_order_relaxed);
+                return fiber;
+            }
+        }
+        return nullptr;
+    }
+
+    Fiber* find_work(Worker& worker) {
+        if (Fiber* fiber = worker.deque.pop()) {
+            return fiber;
+        }
+        if (Fiber* fiber = take_injected()) {
+            return fiber;
+        }
+        // Yielded fibers go behind everything else this worker could run
+        if (Fiber* fiber = worker.yielded.steal()) {
+            return fiber;
+        }
+        return steal(worker);
+    }
+
+    void idle() {
+        // One idle worker waits in the poller, so I/O completions wake it
+        bool expected = false;
+        if (poller_.load(std::memory_order_acquire) != nullptr &&
+            blocking_poll_.compare_exchange_strong(expected, true, std::memory_order_seq_cst)) {
+            if (runnable_.load(std::memory_order_seq_cst) == 0 &&
+                !stopping_.load(std::memory_order_acquire)) {
+                poll(1);
+            }
+            blocking_poll_.store(false, std::memory_order_release);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        // The timeout only bounds a steal that lost a race; wakeups are not lost
+        idle_cv_.wait_for(lock, std::chrono::milliseconds(1), [this] {
+            return runnable_.load(std::memory_order_seq_cst) > 0 ||
+                   stopping_.load(std::memory_order_acquire);
+        });
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void retire(Fiber* fiber) {
+        FiberStack stack = fiber->stack;
+        fiber->~Fiber();
+        {
+            std::lock_guard<std::mutex> lock(stacks_mutex_);
+            stacks_.release(stack);
+        }
+        if (live_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(done_mutex_);
+            done_cv_.notify_all();
+        }
+    }
+
+    void run(Worker& worker) {
+        current_worker_ = &worker;
+        while (true) {
+            // Flush batched I/O submissions now and then even when busy
+            if (++worker.ticks % POLL_INTERVAL == 0) {
+                poll(0);
+            }
+            Fiber* fiber = find_work(worker);
+            if (fiber == nullptr) {
+                if (poll(0) > 0) {
+                    continue;
+                }
+                if (stopping_.load(std::memory_order_acquire)) {
+                    break;
+                }
+                idle();
+                continue;
+            }
+            runnable_.fetch_sub(1, std::memory_order_relaxed);
+
+            worker.current = fiber;
+            FiberContext::swap(worker.context, fiber->context);
+            worker.current = nullptr;
+            worker.scratch.reset();
+
+            // Requeue only once off the fiber's stack, so no thief can
+            // resume it while it is still running here
+            if (fiber->finished) {
+                retire(fiber);
+            } else if (fiber->on_parked != nullptr) {
+                // The callback may resume the fiber on another worker at once
+                void (*on_parked)(Fiber*, void*) = fiber->on_parked;
+                fiber->on_parked = nullptr;
+                on_parked(fiber, fiber->park_arg);
+            } else {
+                enqueue(fiber, true);
+            }
+        }
+        current_worker_ = nullptr;
+    }
+
+public:
+    // Opaque reference to a parked fiber
+    using Handle = Fiber*;
+
+    // workers == 0 starts one worker per hardware thread. max_fibers bounds
+    // the fibers alive at once; stack_size is rounded up to whole pages.
+    explicit FiberScheduler(size_t workers = 0, size_t stack_size = 64 * 1024,
+                            size_t max_fibers = 1024, size_t scratch_size = 64 * 1024)
+        : stacks_(stack_size, max_fibers), injected_(0), runnable_(0), sleepers_(0), live_(0),
+          poller_(nullptr), poller_users_(0), blocking_poll_(false), stopping_(false) {
+        if (workers == 0) {
+            workers = std::thread::hardware_concurrency();
+            workers = workers ? workers : 1;
+        }
+        workers_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            workers_.push_back(std::make_unique<Worker>(this, i, scratch_size));
+        }
+        // Start threads only once every deque exists to be stolen from
+        for (std::unique_ptr<Worker>& worker : workers_) {
+            Worker* raw = worker.get();
+            raw->thread = std::thread([this, raw] { run(*raw); });
+        }
+    }
+
+    FiberScheduler(const FiberScheduler&) = delete;
+    FiberScheduler& operator=(const FiberScheduler&) = delete;
+
+    // Waits for every fiber to finish, then stops the workers
+    ~FiberScheduler() {
+        wait();
+        stopping_.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            idle_cv_.notify_all();
+        }
+        interrupt_poller();
+        for (std::unique_ptr<Worker>& worker : workers_) {
+            worker->thread.join();
+        }
+    }
+
+    // Start func on a new fiber. Safe from any thread, including from inside
+    // a fiber, where the new fiber goes on the current worker's deque.
+    // Returns false when max_fibers are already alive. Pass Mode::FULL for
+    // fibers that keep SIMD/FPU state live across a yield.
+    bool spawn(std::function<void()> func, FiberContext::Mode mode = FiberContext::Mode::LITE) {
+        FiberStack stack;
+        {
+            std::lock_guard<std::mutex> lock(stacks_mutex_);
+            stack = stacks_.acquire();
+        }
+        if (!stack) {
+            return false;
+        }
+
+        // The fiber record sits at the top of its stack; the fiber runs below it
+        uintptr_t top = reinterpret_cast<uintptr_t>(stack.top()) - sizeof(Fiber);
+        top &= ~(uintptr_t(alignof(Fiber) > 16 ? alignof(Fiber) : 16) - 1);
+        Fiber* fiber = new (reinterpret_cast<void*>(top)) Fiber(stack, std::move(func), mode);
+
+        if (!fiber->context.make(stack.base, static_cast<size_t>(top - reinterpret_cast<uintptr_t>(stack.base)),
+                                 &FiberScheduler::entry, fiber)) {
+            fiber->~Fiber();
+            std::lock_guard<std::mutex> lock(stacks_mutex_);
+            stacks_.release(stack);
+            return false;
+        }
+
+        live_.fetch_add(1, std::memory_order_relaxed);
+        enqueue(fiber);
+        return true;
+    }
+
+    // Block until every spawned fiber has finished. Call from outside the
+    // scheduler; a fiber waiting here would never let its worker go.
+    void wait() {
+        std::unique_lock<std::mutex> lock(done_mutex_);
+        done_cv_.wait(lock, [this] { return live_.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Give the worker to another runnable fiber. Outside a fiber this
+    // yields the thread instead.
+    static void yield() {
+        Worker* worker = current_worker();
+        if (worker == nullptr || worker->current == nullptr) {
+            std::this_thread::yield();
+            return;
+        }
+        FiberContext::swap(worker->current->context, worker->context);
+    }
+
+    // Suspend the calling fiber without requeueing it. on_parked(handle, arg)
+    // runs on the worker once the fiber is off its stack, so it may hand
+    // the handle to another thread; resume() must then be called on it
+    // exactly once.
+    static void park(void (*on_parked)(Handle, void*), void* arg) {
+        Worker* worker = current_worker();
+        assert(worker != nullptr && worker->current != nullptr && "park() called outside a fiber");
+        Fiber* fiber = worker->current;
+        fiber->on_parked = on_parked;
+        fiber->park_arg = arg;
+        FiberContext::swap(fiber->context, worker->context);
+    }
+
+    // Make a parked fiber runnable again; callable from any thread
+    void resume(Handle fiber) {
+        enqueue(fiber, true);
+    }
+
+    // Attach the poller workers drive between fibers, or detach it with
+    // nullptr. Detaching waits until no worker is still inside it.
+    void set_poller(FiberPoller* poller) {
+        poller_.store(poller, std::memory_order_seq_cst);
+        if (poller == nullptr) {
+            while (poller_users_.load(std::memory_order_acquire) > 0) {
+                std::this_thread::yield();
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            idle_cv_.notify_all();
+        }
+    }
+
+    // Static method to check whether the caller is running on a fiber
+    static bool in_fiber() {
+        Worker* worker = current_worker();
+        return worker != nullptr && worker->current != nullptr;
+    }
+
+    // Scratch arena of the worker running the calling fiber. Reset as soon
+    // as the fiber yields or finishes.
+    static BumpArena& scratch() {
+        Worker* worker = current_worker();
+        assert(worker != nullptr && "scratch() called outside a fiber");
+        return worker->scratch;
+    }
+
+    // Static method to get the index of the calling worker, or SIZE_MAX
+    // outside the scheduler's threads
+    static size_t worker_index() {
+        Worker* worker = current_worker();
+        return worker != nullptr ? worker->index : SIZE_MAX;
+    }
+
+    // Method to get the number of worker threads
+    size_t workers() const {
+        return workers_.size();
+    }
+
+    // Method to get the number of fibers spawned but not yet finished
+    size_t live() const {
+        return live_.load(std::memory_order_relaxed);
+    }
+
+    // Method to get the number of fibers taken from another worker's deque
+    size_t steals() const {
+        size_t total = 0;
+        for (const std::unique_ptr<Worker>& worker : workers_) {
+            total += worker->steals.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+#endif // ARENA_STORAGE_HAS_MMAP
+
+#endif // FIBER_SCHEDULER_HPP
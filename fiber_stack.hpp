@@ -0,0 +1,159 @@
+#ifndef FIBER_STACK_HPP
+#define FIBER_STACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "arena_storage.hpp"
+
+#ifdef ARENA_STORAGE_HAS_MMAP
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+// Usable range of one fiber stack. Stacks grow down from top(); the guard
+// page sits just below base().
+struct FiberStack {
+    char* base;
+    size_t size;
+
+    char* top() const {
+        return base + size;
+    }
+
+    explicit operator bool() const {
+        return base != nullptr;
+    }
+};
+
+// Fixed-size fiber stacks carved from one mmap'd reservation. The whole
+// region is reserved PROT_NONE up front; each slot is a guard page followed
+// by the stack, and only the stack is made writable, the first time the
+// slot is handed out. Pages are committed by the kernel on first touch, so
+// a large stack costs only what the fiber actually uses. Released stacks go
+// on a free list and are reused without a syscall; with decommit enabled
+// their pages (all but the top one) are returned with MADV_DONTNEED first.
+//
+// Every guarded stack is two mappings as far as the kernel is concerned;
+// pools of more than ~30000 stacks need a larger vm.max_map_count.
+// Not thread-safe.
+class FiberStackPool {
+private:
+    struct FreeStack {
+        FreeStack* next;
+    };
+
+    char* region_;             // Start of the reservation
+    size_t region_size_;
+    size_t page_size_;
+    size_t stack_size_;        // Usable bytes per stack, page-rounded
+    size_t slot_size_;         // Guard plus stack
+    size_t capacity_;          // Slots in the reservation
+    size_t carved_;            // Slots handed out at least once
+    size_t in_use_;
+    bool decommit_;
+    FreeStack* free_;
+
+    static size_t round_up(size_t value, size_t granule) {
+        return (value + granule - 1) / granule * granule;
+    }
+
+    // The free-list link lives at the top of the stack, which stays
+    // committed when the rest is decommitted
+    FreeStack* link_of(char* base) const {
+        return reinterpret_cast<FreeStack*>(base + stack_size_ - page_size_);
+    }
+
+    char* base_of(FreeStack* link) const {
+        return reinterpret_cast<char*>(link) + page_size_ - stack_size_;
+    }
+
+public:
+    FiberStackPool(size_t stack_size, size_t max_stacks, bool decommit = false)
+        : region_(nullptr), region_size_(0), page_size_(static_cast<size_t>(sysconf(_SC_PAGESIZE))),
+          stack_size_(0), slot_size_(0), capacity_(max_stacks), carved_(0), in_use_(0),
+          decommit_(decommit), free_(nullptr) {
+        stack_size_ = round_up(stack_size ? stack_size : 1, page_size_);
+        slot_size_ = stack_size_ + page_size_;
+        region_size_ = slot_size_ * (capacity_ ? capacity_ : 1);
+
+        void* region = mmap(nullptr, region_size_, PROT_NONE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (region == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        region_ = static_cast<char*>(region);
+    }
+
+    FiberStackPool(const FiberStackPool&) = delete;
+    FiberStackPool& operator=(const FiberStackPool&) = delete;
+
+    ~FiberStackPool() {
+        munmap(region_, region_size_);
+    }
+
+    // Hand out a stack, or an empty FiberStack when every slot is in use
+    FiberStack acquire() {
+        if (free_ != nullptr) {
+            FreeStack* link = free_;
+            free_ = link->next;
+            ++in_use_;
+            return FiberStack{base_of(link), stack_size_};
+        }
+        if (carved_ == capacity_) {
+            return FiberStack{nullptr, 0};
+        }
+
+        char* base = region_ + carved_ * slot_size_ + page_size_;
+        if (mprotect(base, stack_size_, PROT_READ | PROT_WRITE) != 0) {
+            return FiberStack{nullptr, 0};
+        }
+        ++carved_;
+        ++in_use_;
+        return FiberStack{base, stack_size_};
+    }
+
+    void release(FiberStack stack) {
+        if (!stack) {
+            return;
+        }
+        if (decommit_ && stack_size_ > page_size_) {
+            madvise(stack.base, stack_size_ - page_size_, MADV_DONTNEED);
+        }
+        FreeStack* link = link_of(stack.base);
+        link->next = free_;
+        free_ = link;
+        --in_use_;
+    }
+
+    // Method to get the usable bytes per stack
+    size_t stack_size() const {
+        return stack_size_;
+    }
+
+    // Method to get the bytes of PROT_NONE guard below each stack
+    size_t guard_size() const {
+        return page_size_;
+    }
+
+    // Method to get the maximum number of stacks
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // Method to get the number of stacks currently handed out
+    size_t in_use() const {
+        return in_use_;
+    }
+
+    // Method to get the number of slots made writable so far
+    size_t carved() const {
+        return carved_;
+    }
+};
+
+#endif // ARENA_STORAGE_HAS_MMAP
+
+#endif // FIBER_STACK_HPP
@@ -0,0 +1,659 @@
+#ifndef MY_STRING_HPP
+#define MY_STRING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+
+#include "string_simd.hpp"
+
+// String resources tell BasicMyString where its heap buffers come from. A
+// resource provides allocate(size), deallocate(ptr, size), extend(ptr,
+// old_size, new_size) and operator==. Sizes include the terminator.
+
+// The global heap. Stateless, so it adds nothing to the string's size.
+struct HeapStringResource {
+    char* allocate(size_t size) {
+        void* buffer = std::malloc(size);
+        if (buffer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<char*>(buffer);
+    }
+
+    void deallocate(char* buffer, size_t /*size*/) {
+        std::free(buffer);
+    }
+
+    bool extend(char* /*buffer*/, size_t /*old_size*/, size_t /*new_size*/) {
+        return false;
+    }
+
+    bool operator==(const HeapStringResource&) const {
+        return true;
+    }
+};
+
+// Draws string buffers from a borrowed bump allocator exposing
+// alloc_aligned(), extend() and reset(). Buffers are never handed back one
+// by one: they are reclaimed en masse when the arena is reset or rewound, so
+// a string may safely be destroyed after its arena was reset, but must not
+// be used. A string whose buffer is the arena's latest allocation grows in
+// place. Exhaustion throws std::bad_alloc.
+template<typename Allocator>
+class ArenaStringResource {
+private:
+    Allocator* allocator_;
+
+public:
+    explicit ArenaStringResource(Allocator& allocator) : allocator_(&allocator) {}
+
+    char* allocate(size_t size) {
+        void* buffer = allocator_->alloc_aligned(size, 1);
+        if (buffer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<char*>(buffer);
+    }
+
+    void deallocate(char* /*buffer*/, size_t /*size*/) {}
+
+    bool extend(char* buffer, size_t old_size, size_t new_size) {
+        return allocator_->extend(buffer, old_size, new_size);
+    }
+
+    bool operator==(const ArenaStringResource& other) const {
+        return allocator_ == other.allocator_;
+    }
+
+    Allocator& allocator() const {
+        return *allocator_;
+    }
+};
+
+// Non-owning view of characters held by a string or an arena, for taking
+// substrings without copying. Searches and comparisons run on the kernels
+// StringKernels::best() picked for this CPU. A slice is valid only while its
+// characters are: until the arena is reset or rewound, or the string is
+// modified, moved or destroyed. A short string keeps its characters inside
+// the string object, so moving it also invalidates slices taken from it.
+class StringSlice {
+private:
+    const char* data_;
+    size_t size_;
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    StringSlice() : data_(""), size_(0) {}
+    StringSlice(const char* data, size_t size) : data_(data), size_(size) {}
+    StringSlice(std::string_view view) : data_(view.data()), size_(view.size()) {}
+
+    // Sub-slice of up to n characters from pos; pos is clamped to size()
+    StringSlice slice(size_t pos, size_t n = npos) const {
+        if (pos > size_) {
+            pos = size_;
+        }
+        return StringSlice(data_ + pos, n < size_ - pos ? n : size_ - pos);
+    }
+
+    size_t find(char ch, size_t pos = 0) const {
+        if (pos >= size_) {
+            return npos;
+        }
+        size_t hit = StringKernels::best().find_char(data_ + pos, size_ - pos, ch);
+        return hit == npos ? npos : pos + hit;
+    }
+
+    size_t find(std::string_view needle, size_t pos = 0) const {
+        if (pos > size_) {
+            return npos;
+        }
+        size_t hit = StringKernels::best().find(data_ + pos, size_ - pos, needle.data(), needle.size());
+        return hit == npos ? npos : pos + hit;
+    }
+
+    size_t rfind(char ch, size_t pos = npos) const {
+        return StringKernels::best().rfind_char(data_, pos < size_ ? pos + 1 : size_, ch);
+    }
+
+    // Matches starting after `pos` are ignored
+    size_t rfind(std::string_view needle, size_t pos = npos) const {
+        size_t length = size_;
+        if (pos < length && needle.size() < length - pos) {
+            length = pos + needle.size();
+        }
+        return StringKernels::best().rfind(data_, length, needle.data(), needle.size());
+    }
+
+    bool contains(std::string_view needle) const {
+        return find(needle) != npos;
+    }
+
+    int compare(std::string_view other) const {
+        size_t common = size_ < other.size() ? size_ : other.size();
+        int result = StringKernels::best().compare(data_, other.data(), common);
+        if (result != 0) {
+            return result;
+        }
+        return size_ < other.size() ? -1 : (size_ > other.size() ? 1 : 0);
+    }
+
+    bool equals(std::string_view other) const {
+        return size_ == other.size() && StringKernels::best().equals(data_, other.data(), size_);
+    }
+
+    bool starts_with(std::string_view prefix) const {
+        return prefix.size() <= size_ && StringKernels::best().equals(data_, prefix.data(), prefix.size());
+    }
+
+    bool ends_with(std::string_view suffix) const {
+        return suffix.size() <= size_ &&
+               StringKernels::best().equals(data_ + size_ - suffix.size(), suffix.data(), suffix.size());
+    }
+
+    const char& operator[](size_t pos) const {
+        return data_[pos];
+    }
+
+    const char* begin() const {
+        return data_;
+    }
+
+    const char* end() const {
+        return data_ + size_;
+    }
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    std::string_view view() const {
+        return std::string_view(data_, size_);
+    }
+
+    operator std::string_view() const {
+        return view();
+    }
+
+    friend bool operator==(const StringSlice& lhs, std::string_view rhs) {
+        return lhs.equals(rhs);
+    }
+
+    friend bool operator!=(const StringSlice& lhs, std::string_view rhs) {
+        return !lhs.equals(rhs);
+    }
+
+    friend bool operator<(const StringSlice& lhs, std::string_view rhs) {
+        return lhs.compare(rhs) < 0;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const StringSlice& slice) {
+        return out << slice.view();
+    }
+};
+
+// String with a small-string buffer the size of its heap representation:
+// up to 23 characters on 64-bit targets live inside the object and never
+// touch the resource. The last inline byte holds the unused inline capacity,
+// so a full inline string doubles it as the terminator; a heap string marks
+// it through the top bit of its capacity. Longer strings grow by 1.5x, first
+// trying to extend the buffer in place. data() is always NUL-terminated.
+template<typename Resource = HeapStringResource>
+class BasicMyString : private Resource {
+private:
+    struct Heap {
+        char* data;
+        size_t size;
+        size_t capacity;       // Packed with the heap mark, see pack()
+    };
+
+    static constexpr size_t INLINE_CAPACITY = sizeof(Heap) - 1;
+    static constexpr size_t MINIMUM_CAPACITY = 2 * INLINE_CAPACITY + 1;
+    static constexpr unsigned char HEAP_BYTE = 0x80;
+
+    union {
+        Heap heap_;
+        char inline_[sizeof(Heap)];
+    };
+
+    // The heap mark has to land in the last byte of the object
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static size_t pack(size_t capacity) {
+        return (capacity << 8) | HEAP_BYTE;
+    }
+
+    static size_t unpack(size_t packed) {
+        return packed >> 8;
+    }
+
+    static constexpr size_t MAX_CAPACITY = (SIZE_MAX >> 8) - 1;
+#else
+    static constexpr size_t HEAP_MARK = static_cast<size_t>(HEAP_BYTE) << (8 * (sizeof(size_t) - 1));
+
+    static size_t pack(size_t capacity) {
+        return capacity | HEAP_MARK;
+    }
+
+    static size_t unpack(size_t packed) {
+        return packed & ~HEAP_MARK;
+    }
+
+    static constexpr size_t MAX_CAPACITY = HEAP_MARK - 2;
+#endif
+
+    // Heap buffer left behind by grow(), released once the caller has
+    // finished reading from it
+    struct Released {
+        char* data;
+        size_t size;
+    };
+
+    Resource& resource_ref() {
+        return *this;
+    }
+
+    void set_inline_size(size_t size) {
+        inline_[size] = '\0';
+        inline_[INLINE_CAPACITY] = static_cast<char>(INLINE_CAPACITY - size);
+    }
+
+    void set_size(size_t size) {
+        if (is_inline()) {
+            set_inline_size(size);
+        } else {
+            heap_.size = size;
+            heap_.data[size] = '\0';
+        }
+    }
+
+    void release(Released old) {
+        if (old.data != nullptr) {
+            resource_ref().deallocate(old.data, old.size);
+        }
+    }
+
+    void release_heap() {
+        if (!is_inline()) {
+            release(Released{heap_.data, capacity() + 1});
+        }
+    }
+
+    // Make room for `required` characters, preferring in-place growth.
+    // Unless `exact`, the capacity grows geometrically.
+    Released grow(size_t required, bool exact = false) {
+        if (required > MAX_CAPACITY) {
+            throw std::length_error("BasicMyString: length exceeds max_size()");
+        }
+        size_t current = capacity();
+        size_t target = required;
+        if (!exact) {
+            size_t preferred = current < MAX_CAPACITY - current / 2 ? current + current / 2 : MAX_CAPACITY;
+            target = required > preferred ? required : preferred;
+            if (target < MINIMUM_CAPACITY) {
+                target = MINIMUM_CAPACITY;
+            }
+        }
+
+        if (!is_inline()) {
+            if (resource_ref().extend(heap_.data, current + 1, target + 1)) {
+                heap_.capacity = pack(target);
+                return Released{nullptr, 0};
+            }
+            if (target != required && resource_ref().extend(heap_.data, current + 1, required + 1)) {
+                heap_.capacity = pack(required);
+                return Released{nullptr, 0};
+            }
+        }
+
+        char* buffer = resource_ref().allocate(target + 1);
+        size_t length = size();
+        std::memcpy(buffer, data(), length + 1);
+        Released old = is_inline() ? Released{nullptr, 0} : Released{heap_.data, current + 1};
+        heap_.data = buffer;
+        heap_.size = length;
+        heap_.capacity = pack(target);
+        return old;
+    }
+
+    // Copy `source`, which may point into this string, to [pos, pos + n)
+    // and end the string there
+    void write(size_t pos, const char* source, size_t n) {
+        size_t length = pos + n;
+        if (is_inline() && n <= INLINE_CAPACITY && pos <= INLINE_CAPACITY - n) {
+            std::memmove(inline_ + pos, source, n);
+            set_inline_size(length);
+            return;
+        }
+
+        Released old{nullptr, 0};
+        if (length > capacity()) {
+            // Growing out of the inline buffer overwrites it, so a source
+            // inside the string is re-pointed at the moved characters
+            uintptr_t offset = reinterpret_cast<uintptr_t>(source) - reinterpret_cast<uintptr_t>(data());
+            bool inside = offset < size();
+            old = grow(length);
+            if (inside) {
+                source = heap_.data + offset;
+            }
+        }
+        std::memmove(heap_.data + pos, source, n);
+        heap_.size = length;
+        heap_.data[length] = '\0';
+        release(old);
+    }
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit BasicMyString(const Resource& resource = Resource()) : Resource(resource) {
+        set_inline_size(0);
+    }
+
+    BasicMyString(std::string_view text, const Resource& resource = Resource()) : Resource(resource) {
+        set_inline_size(0);
+        append(text);
+    }
+
+    BasicMyString(const char* text, const Resource& resource = Resource())
+        : BasicMyString(std::string_view(text), resource) {}
+
+    BasicMyString(const char* text, size_t length, const Resource& resource = Resource())
+        : BasicMyString(std::string_view(text, length), resource) {}
+
+    BasicMyString(size_t count, char ch, const Resource& resource = Resource()) : Resource(resource) {
+        set_inline_size(0);
+        resize(count, ch);
+    }
+
+    // Copies share the source's resource
+    BasicMyString(const BasicMyString& other) : BasicMyString(other.view(), other.resource()) {}
+
+    BasicMyString(BasicMyString&& other) noexcept : Resource(other.resource()) {
+        std::memcpy(static_cast<void*>(&heap_), &other.heap_, sizeof(Heap));
+        other.set_inline_size(0);
+    }
+
+    BasicMyString& operator=(const BasicMyString& other) {
+        if (this != &other) {
+            assign(other.view());
+        }
+        return *this;
+    }
+
+    // Steals the buffer when both strings use the same resource and copies
+    // otherwise, so the string never holds memory from a foreign arena
+    BasicMyString& operator=(BasicMyString&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (!(resource() == other.resource())) {
+            assign(other.view());
+            return *this;
+        }
+        release_heap();
+        std::memcpy(static_cast<void*>(&heap_), &other.heap_, sizeof(Heap));
+        other.set_inline_size(0);
+        return *this;
+    }
+
+    BasicMyString& operator=(std::string_view text) {
+        return assign(text);
+    }
+
+    BasicMyString& operator=(const char* text) {
+        return assign(text);
+    }
+
+    ~BasicMyString() {
+        release_heap();
+    }
+
+    BasicMyString& assign(std::string_view text) {
+        write(0, text.data(), text.size());
+        return *this;
+    }
+
+    BasicMyString& append(std::string_view text) {
+        if (text.size() > MAX_CAPACITY - size()) {
+            throw std::length_error("BasicMyString: length exceeds max_size()");
+        }
+        write(size(), text.data(), text.size());
+        return *this;
+    }
+
+    BasicMyString& append(const char* text, size_t length) {
+        return append(std::string_view(text, length));
+    }
+
+    BasicMyString& operator+=(std::string_view text) {
+        return append(text);
+    }
+
+    BasicMyString& operator+=(const char* text) {
+        return append(text);
+    }
+
+    BasicMyString& operator+=(const BasicMyString& other) {
+        return append(other.view());
+    }
+
+    BasicMyString& operator+=(char ch) {
+        push_back(ch);
+        return *this;
+    }
+
+    void push_back(char ch) {
+        size_t length = size();
+        Released old{nullptr, 0};
+        if (length == capacity()) {
+            old = grow(length + 1);
+        }
+        data()[length] = ch;
+        set_size(length + 1);
+        release(old);
+    }
+
+    void pop_back() {
+        set_size(size() - 1);
+    }
+
+    // Grows to exactly `capacity_wanted`, so a string of known final size
+    // takes one buffer of that size
+    void reserve(size_t capacity_wanted) {
+        if (capacity_wanted > capacity()) {
+            release(grow(capacity_wanted, true));
+        }
+    }
+
+    void resize(size_t length, char ch = '\0') {
+        size_t current = size();
+        if (length > current) {
+            reserve(length);
+            std::memset(data() + current, ch, length - current);
+        }
+        set_size(length);
+    }
+
+    // Keeps the buffer for reuse
+    void clear() {
+        set_size(0);
+    }
+
+    // View of up to n characters from pos without copying; pos is clamped
+    // to size(). See StringSlice for how long it stays valid.
+    StringSlice slice(size_t pos = 0, size_t n = npos) const {
+        return StringSlice(data(), size()).slice(pos, n);
+    }
+
+    // Searches and comparisons go through StringSlice, so they run on the
+    // kernels StringKernels::best() picked for this CPU
+    size_t find(char ch, size_t pos = 0) const {
+        return slice().find(ch, pos);
+    }
+
+    size_t find(std::string_view needle, size_t pos = 0) const {
+        return slice().find(needle, pos);
+    }
+
+    size_t rfind(char ch, size_t pos = npos) const {
+        return slice().rfind(ch, pos);
+    }
+
+    // Matches starting after `pos` are ignored
+    size_t rfind(std::string_view needle, size_t pos = npos) const {
+        return slice().rfind(needle, pos);
+    }
+
+    bool contains(std::string_view needle) const {
+        return slice().contains(needle);
+    }
+
+    int compare(std::string_view other) const {
+        return slice().compare(other);
+    }
+
+    bool equals(std::string_view other) const {
+        return slice().equals(other);
+    }
+
+    bool starts_with(std::string_view prefix) const {
+        return slice().starts_with(prefix);
+    }
+
+    bool ends_with(std::string_view suffix) const {
+        return slice().ends_with(suffix);
+    }
+
+    // ASCII case conversion in place
+    void to_lower() {
+        StringKernels::best().to_lower(data(), size());
+    }
+
+    void to_upper() {
+        StringKernels::best().to_upper(data(), size());
+    }
+
+    char& operator[](size_t pos) {
+        return data()[pos];
+    }
+
+    const char& operator[](size_t pos) const {
+        return data()[pos];
+    }
+
+    char* begin() {
+        return data();
+    }
+
+    char* end() {
+        return data() + size();
+    }
+
+    const char* begin() const {
+        return data();
+    }
+
+    const char* end() const {
+        return data() + size();
+    }
+
+    char* data() {
+        return is_inline() ? inline_ : heap_.data;
+    }
+
+    const char* data() const {
+        return is_inline() ? inline_ : heap_.data;
+    }
+
+    const char* c_str() const {
+        return data();
+    }
+
+    std::string_view view() const {
+        return std::string_view(data(), size());
+    }
+
+    operator std::string_view() const {
+        return view();
+    }
+
+    // Method to get the length in characters
+    size_t size() const {
+        return is_inline() ? INLINE_CAPACITY - static_cast<unsigned char>(inline_[INLINE_CAPACITY])
+                           : heap_.size;
+    }
+
+    size_t length() const {
+        return size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // Method to get how many characters fit without growing
+    size_t capacity() const {
+        return is_inline() ? INLINE_CAPACITY : unpack(heap_.capacity);
+    }
+
+    static constexpr size_t max_size() {
+        return MAX_CAPACITY;
+    }
+
+    static constexpr size_t inline_capacity() {
+        return INLINE_CAPACITY;
+    }
+
+    // Method to check whether the characters live inside the object
+    bool is_inline() const {
+        return (static_cast<unsigned char>(inline_[INLINE_CAPACITY]) & HEAP_BYTE) == 0;
+    }
+
+    // Method to get the resource buffers come from
+    const Resource& resource() const {
+        return *this;
+    }
+
+    friend BasicMyString operator+(BasicMyString lhs, std::string_view rhs) {
+        lhs.append(rhs);
+        return lhs;
+    }
+
+    friend bool operator==(const BasicMyString& lhs, std::string_view rhs) {
+        return lhs.equals(rhs);
+    }
+
+    friend bool operator!=(const BasicMyString& lhs, std::string_view rhs) {
+        return !lhs.equals(rhs);
+    }
+
+    friend bool operator<(const BasicMyString& lhs, std::string_view rhs) {
+        return lhs.compare(rhs) < 0;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const BasicMyString& str) {
+        return out << str.view();
+    }
+};
+
+using MyString = BasicMyString<>;
+
+// String whose buffers live in a bump allocator, e.g. ArenaString<BumpArena>
+template<typename Allocator>
+using ArenaString = BasicMyString<ArenaStringResource<Allocator>>;
+
+#endif // MY_STRING_HPP
@@ -0,0 +1,428 @@
+#ifndef PERF_ASSERT_HPP
+#define PERF_ASSERT_HPP
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+
+#include <simpletest.h>
+#include "task3.hpp"
+
+// Performance assertions for simpletest suites.
+//
+// TEST_FASTER_THAN and TEST_WITHIN_BUDGET time callables with Benchmark::run
+// and compare medians. TEST_NO_HEAP_ALLOC counts global heap calls made by
+// the calling thread inside its block. The counting replaces the global
+// operator new/delete and, with glibc outside sanitizer builds, malloc,
+// calloc, realloc, aligned_alloc, posix_memalign and free, so, like
+// simpletest.h, this header belongs in exactly one translation unit: the
+// test executable's.
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define PERF_ASSERT_SANITIZER 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define PERF_ASSERT_SANITIZER 1
+#endif
+
+// Sanitizers intercept malloc themselves; there only operator new is counted
+#if defined(__GLIBC__) && !defined(PERF_ASSERT_SANITIZER)
+#define PERF_ASSERT_HOOKS_MALLOC 1
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t align, size_t size);
+void __libc_free(void* ptr);
+}
+#endif
+
+// Heap calls made by one thread. Every hook bumps these; scopes read deltas.
+struct HeapCounts {
+    size_t allocations;
+    size_t bytes;
+    size_t frees;
+};
+
+namespace heap_hooks {
+
+// Constant-initialized and trivial, so the hooks can touch it at any point
+// in a thread's life without allocating
+inline HeapCounts& counts() {
+    static thread_local HeapCounts current = {0, 0, 0};
+    return current;
+}
+
+inline void note_allocation(size_t size) {
+    HeapCounts& current = counts();
+    ++current.allocations;
+    current.bytes += size;
+}
+
+inline void* allocate(size_t size) {
+    note_allocation(size);
+#ifdef PERF_ASSERT_HOOKS_MALLOC
+    return __libc_malloc(size);
+#else
+    return std::malloc(size);
+#endif
+}
+
+inline void* allocate_aligned(size_t size, size_t align) {
+    note_allocation(size);
+#ifdef PERF_ASSERT_HOOKS_MALLOC
+    return __libc_memalign(align, size);
+#else
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+}
+
+inline void release(void* ptr) {
+    if (ptr != nullptr) {
+        ++counts().frees;
+    }
+#ifdef PERF_ASSERT_HOOKS_MALLOC
+    __libc_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+// operator new semantics: retry through the new handler, then throw
+inline void* allocate_or_throw(size_t size, size_t align) {
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        void* ptr = align > alignof(std::max_align_t) ? allocate_aligned(size, align) : allocate(size);
+        if (ptr != nullptr) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // namespace heap_hooks
+
+// Global heap calls made by this thread since construction (or until
+// stop()). Work handed to other threads is not counted.
+class HeapAllocationCounter {
+private:
+    HeapCounts start_;
+    HeapCounts stop_;
+    bool running_;
+
+public:
+    // Whether malloc and friends are counted, not only operator new
+#ifdef PERF_ASSERT_HOOKS_MALLOC
+    static constexpr bool hooks_malloc = true;
+#else
+    static constexpr bool hooks_malloc = false;
+#endif
+
+    HeapAllocationCounter() : start_(heap_hooks::counts()), stop_(start_), running_(true) {}
+
+    void stop() {
+        if (running_) {
+            stop_ = heap_hooks::counts();
+            running_ = false;
+        }
+    }
+
+    bool running() const {
+        return running_;
+    }
+
+    // Method to get the allocations made so far
+    size_t allocations() const {
+        return (running_ ? heap_hooks::counts() : stop_).allocations - start_.allocations;
+    }
+
+    // Method to get the bytes requested so far
+    size_t bytes() const {
+        return (running_ ? heap_hooks::counts() : stop_).bytes - start_.bytes;
+    }
+
+    // Method to get the non-null frees made so far
+    size_t frees() const {
+        return (running_ ? heap_hooks::counts() : stop_).frees - start_.frees;
+    }
+
+    bool touched_heap() const {
+        return allocations() != 0 || frees() != 0;
+    }
+
+    std::string summary() const {
+        return std::to_string(allocations()) + " allocations of " + std::to_string(bytes()) + " bytes, " +
+               std::to_string(frees()) + " frees";
+    }
+};
+
+// Timing behind TEST_FASTER_THAN and TEST_WITHIN_BUDGET
+class PerfAssert {
+public:
+    // Shorter than the Benchmark defaults so assertions suit a unit test
+    // run. A failing comparison is measured again up to `attempts` times
+    // before it is reported, which absorbs one-off scheduling noise.
+    struct Config {
+        std::chrono::nanoseconds warmup_time{std::chrono::milliseconds(2)};
+        std::chrono::nanoseconds min_sample_time{std::chrono::microseconds(50)};
+        std::chrono::nanoseconds target_time{std::chrono::milliseconds(20)};
+        size_t max_samples = 200;
+        size_t attempts = 3;
+    };
+
+    static Config& config() {
+        static Config instance;
+        return instance;
+    }
+
+    struct Outcome {
+        bool passed;
+        std::string detail;
+    };
+
+    // Passes if candidate's median is at most max_ratio times reference's
+    template<typename Candidate, typename Reference>
+    static Outcome faster_than(Candidate&& candidate, Reference&& reference, double max_ratio) {
+        std::lock_guard<std::mutex> lock(mutex());
+        double candidate_ns = 0;
+        double reference_ns = 0;
+        for (size_t attempt = 0; attempt < attempts(); ++attempt) {
+            reference_ns = median_ns(reference);
+            candidate_ns = median_ns(candidate);
+            if (candidate_ns <= reference_ns * max_ratio) {
+                break;
+            }
+        }
+        char detail[96];
+        std::snprintf(detail, sizeof(detail), "%.1f ns vs %.1f ns, %.2fx, limit %.2fx", candidate_ns, reference_ns,
+                      reference_ns > 0 ? candidate_ns / reference_ns : 0.0, max_ratio);
+        return Outcome{candidate_ns <= reference_ns * max_ratio, detail};
+    }
+
+    // Passes if func's median per call is within `budget`
+    template<typename Func, typename Rep, typename Period>
+    static Outcome within_budget(Func&& func, std::chrono::duration<Rep, Period> budget) {
+        std::lock_guard<std::mutex> lock(mutex());
+        double budget_ns = std::chrono::duration<double, std::nano>(budget).count();
+        double ns = 0;
+        for (size_t attempt = 0; attempt < attempts(); ++attempt) {
+            ns = median_ns(func);
+            if (ns <= budget_ns) {
+                break;
+            }
+        }
+        char detail[64];
+        std::snprintf(detail, sizeof(detail), "%.1f ns, budget %.1f ns", ns, budget_ns);
+        return Outcome{ns <= budget_ns, detail};
+    }
+
+private:
+    // Benchmark::config() and recorded() are process-wide, and timings
+    // taken side by side disturb each other, so measurements from parallel
+    // test groups take turns
+    static std::mutex& mutex() {
+        static std::mutex instance;
+        return instance;
+    }
+
+    static size_t attempts() {
+        return config().attempts != 0 ? config().attempts : 1;
+    }
+
+    template<typename Func>
+    static double median_ns(Func& func) {
+        Benchmark::Config saved = Benchmark::config();
+        Benchmark::Config& active = Benchmark::config();
+        active.warmup_time = config().warmup_time;
+        active.min_sample_time = config().min_sample_time;
+        active.target_time = config().target_time;
+        active.max_samples = config().max_samples;
+        active.enable_counters = false;
+
+        Benchmark::Result result = Benchmark::run("perf assertion", func, 10);
+        Benchmark::recorded().pop_back();
+        Benchmark::config() = saved;
+        return result.median_ns;
+    }
+};
+
+// Global replacements. libstdc++ would forward most forms to the plain
+// ones, but sanitizer runtimes define each form themselves, so every form is
+// replaced.
+void* operator new(size_t size) {
+    return heap_hooks::allocate_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size) {
+    return heap_hooks::allocate_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    return heap_hooks::allocate_or_throw(size, static_cast<size_t>(align));
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    return heap_hooks::allocate_or_throw(size, static_cast<size_t>(align));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return heap_hooks::allocate_or_throw(size, alignof(std::max_align_t));
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return heap_hooks::allocate_or_throw(size, static_cast<size_t>(align));
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return operator new(size, align, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    heap_hooks::release(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    heap_hooks::release(ptr);
+}
+
+#ifdef PERF_ASSERT_HOOKS_MALLOC
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+    return heap_hooks::allocate(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    heap_hooks::note_allocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    if (ptr != nullptr && size == 0) {
+        ++heap_hooks::counts().frees;
+    } else {
+        heap_hooks::note_allocation(size);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t align, size_t size) noexcept {
+    return heap_hooks::allocate_aligned(size, align);
+}
+
+int posix_memalign(void** out, size_t align, size_t size) noexcept {
+    if (align < sizeof(void*) || (align & (align - 1)) != 0) {
+        return EINVAL;
+    }
+    void* ptr = heap_hooks::allocate_aligned(size, align);
+    if (ptr == nullptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+void free(void* ptr) noexcept {
+    heap_hooks::release(ptr);
+}
+
+}
+#endif
+
+// Fail unless `candidate` takes at most max_ratio times as long per call as
+// `reference`. Both are callables, usually lambdas named beforehand.
+#define TEST_FASTER_THAN(candidate, reference, max_ratio, message) \
+    do { \
+        PerfAssert::Outcome simpletest_outcome = PerfAssert::faster_than(candidate, reference, max_ratio); \
+        TEST_MESSAGE(simpletest_outcome.passed, message << " (" << simpletest_outcome.detail << ")"); \
+    } while(0)
+
+// Fail unless `func` takes at most `budget` (a std::chrono duration) per call
+#define TEST_WITHIN_BUDGET(func, budget, message) \
+    do { \
+        PerfAssert::Outcome simpletest_outcome = PerfAssert::within_budget(func, budget); \
+        TEST_MESSAGE(simpletest_outcome.passed, message << " (" << simpletest_outcome.detail << ")"); \
+    } while(0)
+
+// Fail if the block that follows allocates or frees through the global heap
+// on this thread:
+//
+//     TEST_NO_HEAP_ALLOC("Bump allocation stays off the heap") {
+//         allocator.alloc<int>(16);
+//     }
+//
+// The check runs when the block completes normally; leaving it with break,
+// return or an exception skips it.
+#define TEST_NO_HEAP_ALLOC(message) \
+    for (HeapAllocationCounter simpletest_heap_counter; simpletest_heap_counter.running(); \
+         simpletest_heap_counter.stop(), [&] { \
+             TEST_MESSAGE(!simpletest_heap_counter.touched_heap(), \
+                          message << " (" << simpletest_heap_counter.summary() << ")"); \
+         }())
+
+#endif // PERF_ASSERT_HPP
@@ -0,0 +1,152 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_AVAILABLE 1
+#endif
+
+// Hardware counters for the calling thread and the threads it creates while
+// the counters are open, read through perf_event_open. Each counter is
+// opened on its own so a missing one (no PMU, restricted
+// perf_event_paranoid, non-Linux build) only drops that counter; when none
+// can be opened every read is simply empty. Six events exceed the general
+// counters on most cores, so the kernel multiplexes them: each count is
+// scaled by time enabled / time running to estimate the full window.
+class PerfCounters {
+public:
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        DTLB_MISSES,
+        BRANCH_MISSES,
+        EVENT_COUNT
+    };
+
+    static const char* event_name(size_t event) {
+        static const char* const names[EVENT_COUNT] = {
+            "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"
+        };
+        return names[event];
+    }
+
+private:
+    int fds_[EVENT_COUNT];
+
+#ifdef PERF_COUNTERS_AVAILABLE
+    static int open_event(uint32_t type, uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;  // Count threads spawned while open, as in measure_threads
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static uint64_t cache_event(uint64_t cache, uint64_t result) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+    }
+#endif
+
+public:
+    PerfCounters() {
+        for (int& fd : fds_) {
+            fd = -1;
+        }
+#ifdef PERF_COUNTERS_AVAILABLE
+        fds_[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds_[INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds_[L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE,
+                                      cache_event(PERF_COUNT_HW_CACHE_L1D,
+                                                  PERF_COUNT_HW_CACHE_RESULT_MISS));
+        fds_[LLC_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fds_[DTLB_MISSES] = open_event(PERF_TYPE_HW_CACHE,
+                                       cache_event(PERF_COUNT_HW_CACHE_DTLB,
+                                                   PERF_COUNT_HW_CACHE_RESULT_MISS));
+        fds_[BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#ifdef PERF_COUNTERS_AVAILABLE
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    // Method to check whether at least one counter could be opened
+    bool available() const {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void start() {
+#ifdef PERF_COUNTERS_AVAILABLE
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    void stop() {
+#ifdef PERF_COUNTERS_AVAILABLE
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Counts since start(), scaled for multiplexing and divided by `calls`,
+    // for every counter that was scheduled at least once
+    std::vector<std::pair<std::string, double>> read(size_t calls) const {
+        std::vector<std::pair<std::string, double>> values;
+#ifdef PERF_COUNTERS_AVAILABLE
+        for (size_t event = 0; event < EVENT_COUNT; ++event) {
+            uint64_t value[3] = {0, 0, 0};  // count, time enabled, time running
+            if (fds_[event] < 0 || ::read(fds_[event], value, sizeof(value)) != sizeof(value) || value[2] == 0) {
+                continue;
+            }
+            double count = static_cast<double>(value[0]);
+            if (value[2] < value[1]) {
+                count *= static_cast<double>(value[1]) / static_cast<double>(value[2]);
+            }
+            values.emplace_back(event_name(event), count / static_cast<double>(calls ? calls : 1));
+        }
+#else
+        (void)calls;
+#endif
+        return values;
+    }
+};
+
+#endif // PERF_COUNTERS_HPP
@@ -0,0 +1,138 @@
+#ifndef POOL_ALLOCATOR_HPP
+#define POOL_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Fixed-size object pool with O(1) alloc and free. Freed blocks are kept on
+// an intrusive free list threaded through the blocks themselves; fresh chunks
+// are carved lazily with a bump cursor. Chunks come from malloc by default or
+// from a borrowed bump allocator, which then owns their memory.
+template<typename T, size_t BlocksPerChunk = 64>
+class PoolAllocator {
+    static_assert(BlocksPerChunk > 0, "PoolAllocator needs at least one block per chunk");
+
+private:
+    // A block is either a free-list link or storage for one T
+    union Block {
+        Block* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Chunk {
+        Chunk* next;
+        Block blocks[BlocksPerChunk];
+    };
+
+    using ChunkAllocFn = void* (*)(void* source, size_t size, size_t align);
+
+    Block* free_;              // Intrusive list of freed blocks
+    Block* bump_;              // Next never-used block in the newest chunk
+    Block* bump_end_;          // End of the newest chunk
+    Chunk* chunks_;            // Every chunk obtained so far
+    void* source_;             // Borrowed chunk source, nullptr for malloc
+    ChunkAllocFn chunk_alloc_;
+    size_t allocations_;       // Counter for live blocks
+    size_t free_count_;        // Blocks on the free list
+
+    template<typename Arena>
+    static void* alloc_from(void* source, size_t size, size_t align) {
+        return static_cast<Arena*>(source)->alloc_aligned(size, align);
+    }
+
+    bool refill() {
+        void* raw = source_ != nullptr ? chunk_alloc_(source_, sizeof(Chunk), alignof(Chunk))
+                                       : std::malloc(sizeof(Chunk));
+        if (raw == nullptr) {
+            return false;
+        }
+        Chunk* chunk = static_cast<Chunk*>(raw);
+        chunk->next = chunks_;
+        chunks_ = chunk;
+        bump_ = chunk->blocks;
+        bump_end_ = chunk->blocks + BlocksPerChunk;
+        return true;
+    }
+
+public:
+    PoolAllocator()
+        : free_(nullptr), bump_(nullptr), bump_end_(nullptr), chunks_(nullptr),
+          source_(nullptr), chunk_alloc_(nullptr), allocations_(0), free_count_(0) {}
+
+    // Carve chunks from `arena` (anything with alloc_aligned), which must
+    // outlive the pool
+    template<typename Arena>
+    explicit PoolAllocator(Arena& arena)
+        : free_(nullptr), bump_(nullptr), bump_end_(nullptr), chunks_(nullptr),
+          source_(&arena), chunk_alloc_(&alloc_from<Arena>), allocations_(0),
+          free_count_(0) {}
+
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+    ~PoolAllocator() {
+        if (source_ == nullptr) {
+            while (chunks_ != nullptr) {
+                Chunk* next = chunks_->next;
+                std::free(chunks_);
+                chunks_ = next;
+            }
+        }
+    }
+
+    // Storage for one T, or nullptr if no chunk could be obtained
+    T* alloc() {
+        Block* block = free_;
+        if (block != nullptr) {
+            free_ = block->next;
+            --free_count_;
+        } else {
+            if (bump_ == bump_end_ && !refill()) {
+                return nullptr;
+            }
+            block = bump_++;
+        }
+
+        ++allocations_;
+        return reinterpret_cast<T*>(block->storage);
+    }
+
+    // Return one block obtained from alloc()
+    void dealloc(T* ptr) {
+        if (ptr == nullptr) {
+            return;
+        }
+        Block* block = reinterpret_cast<Block*>(ptr);
+        block->next = free_;
+        free_ = block;
+        ++free_count_;
+        --allocations_;
+    }
+
+    // Static method to get the size of one block
+    static constexpr size_t block_size() {
+        return sizeof(Block);
+    }
+
+    // Method to get current number of live blocks
+    size_t allocations() const {
+        return allocations_;
+    }
+
+    // Method to get bytes available without obtaining another chunk
+    size_t remaining_space() const {
+        return (free_count_ + static_cast<size_t>(bump_end_ - bump_)) * sizeof(Block);
+    }
+
+    // Method to get the number of chunks obtained so far
+    size_t chunk_count() const {
+        size_t count = 0;
+        for (Chunk* chunk = chunks_; chunk != nullptr; chunk = chunk->next) {
+            ++count;
+        }
+        return count;
+    }
+};
+
+#endif // POOL_ALLOCATOR_HPP
@@ -1,51 +1,330 @@
 #ifndef SIMPLETEST_H
 #define SIMPLETEST_H
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <sstream>
 
-// Test fixture class to manage test execution and reporting
+// Test fixture class to manage test execution and reporting. Counters and
+// the report stream are per thread, so groups can run in parallel.
 class TestFixture {
 private:
-    static int passedTests;
-    static int totalTests;
+    struct Counters {
+        int passed = 0;
+        int total = 0;
+        std::ostream* out = &std::cout;
+    };
+
+    static Counters& counters() {
+        thread_local Counters current;
+        return current;
+    }
 
 public:
     static bool ExecuteTestGroup(const char* groupName, bool verbose = false) {
-        std::cout << "\nTest Group: " << groupName << std::endl;
-        std::cout << "Passed " << passedTests << " out of " << totalTests << " tests." << std::endl;
-        bool allPassed = (passedTests == totalTests);
+        (void)verbose;
+        Out() << "\nTest Group: " << groupName << std::endl;
+        Out() << "Passed " << Passed() << " out of " << Total() << " tests." << std::endl;
+        bool allPassed = (Passed() == Total());
         // Reset counters for next group
-        passedTests = 0;
-        totalTests = 0;
+        ResetCounters();
         return allPassed;
     }
 
-    static void IncrementPassed() { passedTests++; }
-    static void IncrementTotal() { totalTests++; }
-    static bool Verbose;
+    static void IncrementPassed() { counters().passed++; }
+    static void IncrementTotal() { counters().total++; }
+    static int Passed() { return counters().passed; }
+    static int Total() { return counters().total; }
+    static void ResetCounters() { counters().passed = counters().total = 0; }
+
+    // Stream the calling thread reports to
+    static std::ostream& Out() { return *counters().out; }
+    static void SetOut(std::ostream* out) { counters().out = out; }
+
+    static inline bool Verbose = true;  // Set to true by default for better visibility
+};
+
+// A test registered by DEFINE_TEST_G
+struct TestCase {
+    const char* group;
+    const char* name;
+    void (*func)();
+};
+
+// Every test in the program, in definition order
+class TestRegistry {
+public:
+    static std::vector<TestCase>& Tests() {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    static bool Add(const char* group, const char* name, void (*func)()) {
+        Tests().push_back(TestCase{group, name, func});
+        return true;
+    }
 };
 
-bool TestFixture::Verbose = true;  // Set to true by default for better visibility
-int TestFixture::passedTests = 0;
-int TestFixture::totalTests = 0;
+// Macro to define a test function and register it with its group
+#define DEFINE_TEST_G(name, group) \
+    void TEST_##name##_##group(); \
+    [[maybe_unused]] static const bool simpletest_registered_##name##_##group = \
+        TestRegistry::Add(#group, #name, TEST_##name##_##group); \
+    void TEST_##name##_##group()
+
+// Runs registered tests group by group. With more than one job, groups are
+// spread over a thread pool; each group still runs its tests in order on one
+// thread and its report is buffered, then printed in registration order.
+class TestRunner {
+public:
+    struct Options {
+        size_t jobs = 0;           // 0: one per hardware thread
+        std::string filter;        // Comma-separated Group.Name patterns
+        size_t slowest = 5;        // Slowest tests listed at the end
+    };
+
+    struct Timing {
+        std::string test;          // Group.Name
+        double ms;
+        bool passed;
+    };
+
+    // Glob match with * and ?; a pattern without wildcards matches any
+    // name containing it
+    static bool Matches(const std::string& pattern, const std::string& text) {
+        if (pattern.find_first_of("*?") == std::string::npos) {
+            return text.find(pattern) != std::string::npos;
+        }
+        size_t p = 0, t = 0, star = std::string::npos, resume = 0;
+        while (t < text.size()) {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+                ++p;
+                ++t;
+            } else if (p < pattern.size() && pattern[p] == '*') {
+                star = p++;
+                resume = t;
+            } else if (star != std::string::npos) {
+                p = star + 1;
+                t = ++resume;
+            } else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*') {
+            ++p;
+        }
+        return p == pattern.size();
+    }
+
+    static bool Selected(const std::string& filter, const std::string& test) {
+        if (filter.empty()) {
+            return true;
+        }
+        std::stringstream patterns(filter);
+        std::string pattern;
+        while (std::getline(patterns, pattern, ',')) {
+            if (!pattern.empty() && Matches(pattern, test)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [--filter PATTERNS] [--jobs N] [--slowest N] [--quiet] [--list]\n"
+                  << "  --filter PATTERNS run Group.Name tests matching any comma-separated pattern (* and ?)\n"
+                  << "  --jobs N          run up to N groups in parallel (default: all cores)\n"
+                  << "  --slowest N       list the N slowest tests at the end (default 5)\n"
+                  << "  --quiet           report failures only\n"
+                  << "  --list            print the selected tests without running them\n";
+    }
+
+    // Run the selected groups; returns true if every assertion passed
+    static bool Run(const Options& options) {
+        std::vector<Group> groups = Collect(options.filter);
+        if (groups.empty()) {
+            std::cout << "No tests match '" << options.filter << "'\n";
+            return false;
+        }
 
-// Macro to define a test function
-#define DEFINE_TEST_G(name, group) void TEST_##name##_##group()
+        size_t jobs = options.jobs != 0 ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+        jobs = std::min(jobs, groups.size());
+        auto start = std::chrono::steady_clock::now();
+
+        if (jobs == 1) {
+            for (Group& group : groups) {
+                RunGroup(group, std::cout);
+            }
+        } else {
+            RunParallel(groups, jobs);
+        }
+
+        double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return Summarize(groups, jobs, wall, options.slowest);
+    }
+
+    // Parse the flags above and run; the exit code for main()
+    static int Main(int argc, char** argv) {
+        Options options;
+        bool list = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--filter" && i + 1 < argc) {
+                options.filter = argv[++i];
+            } else if (arg == "--jobs" && i + 1 < argc) {
+                options.jobs = std::strtoul(argv[++i], nullptr, 10);
+            } else if (arg == "--slowest" && i + 1 < argc) {
+                options.slowest = std::strtoul(argv[++i], nullptr, 10);
+            } else if (arg == "--quiet") {
+                TestFixture::Verbose = false;
+            } else if (arg == "--list") {
+                list = true;
+            } else {
+                PrintUsage(argv[0]);
+                return arg == "--help" ? 0 : 2;
+            }
+        }
+
+        if (list) {
+            for (const Group& group : Collect(options.filter)) {
+                for (const TestCase* test : group.tests) {
+                    std::cout << group.name << "." << test->name << "\n";
+                }
+            }
+            return 0;
+        }
+        return Run(options) ? 0 : 1;
+    }
+
+private:
+    struct Group {
+        std::string name;
+        std::vector<const TestCase*> tests;
+        std::vector<Timing> timings;
+        std::ostringstream report;
+        bool passed = true;
+        bool done = false;
+    };
+
+    // Selected tests grouped by name, groups in order of first definition
+    static std::vector<Group> Collect(const std::string& filter) {
+        std::vector<Group> groups;
+        for (const TestCase& test : TestRegistry::Tests()) {
+            if (!Selected(filter, std::string(test.group) + "." + test.name)) {
+                continue;
+            }
+            auto group = std::find_if(groups.begin(), groups.end(),
+                                      [&](const Group& candidate) { return candidate.name == test.group; });
+            if (group == groups.end()) {
+                groups.emplace_back();
+                groups.back().name = test.group;
+                group = groups.end() - 1;
+            }
+            group->tests.push_back(&test);
+        }
+        return groups;
+    }
+
+    static void RunGroup(Group& group, std::ostream& out) {
+        TestFixture::SetOut(&out);
+        TestFixture::ResetCounters();
+        out << "\nRunning test group: " << group.name << "\n";
+        for (const TestCase* test : group.tests) {
+            int failed_before = TestFixture::Total() - TestFixture::Passed();
+            auto start = std::chrono::steady_clock::now();
+            test->func();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            bool passed = TestFixture::Total() - TestFixture::Passed() == failed_before;
+            group.timings.push_back(Timing{group.name + "." + test->name, ms, passed});
+            out << "TIME: " << test->name << " " << std::fixed << std::setprecision(3) << ms << " ms"
+                << std::defaultfloat << std::endl;
+        }
+        group.passed = TestFixture::ExecuteTestGroup(group.name.c_str(), TestFixture::Verbose);
+        TestFixture::SetOut(&std::cout);
+    }
+
+    // Workers take the next unstarted group; this thread prints finished
+    // reports in order so the output reads the same as a serial run
+    static void RunParallel(std::vector<Group>& groups, size_t jobs) {
+        std::atomic<size_t> next(0);
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < jobs; ++i) {
+            workers.emplace_back([&] {
+                for (size_t index = next++; index < groups.size(); index = next++) {
+                    RunGroup(groups[index], groups[index].report);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    groups[index].done = true;
+                    finished.notify_all();
+                }
+            });
+        }
+
+        for (Group& group : groups) {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&] { return group.done; });
+            lock.unlock();
+            std::cout << group.report.str() << std::flush;
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    static bool Summarize(const std::vector<Group>& groups, size_t jobs, double wall, size_t slowest) {
+        std::vector<Timing> timings;
+        bool passed = true;
+        for (const Group& group : groups) {
+            timings.insert(timings.end(), group.timings.begin(), group.timings.end());
+            passed &= group.passed;
+        }
+
+        std::cout << "\nRan " << timings.size() << " tests in " << groups.size() << " groups on " << jobs
+                  << (jobs == 1 ? " thread" : " threads") << " in " << std::fixed << std::setprecision(1)
+                  << wall << " ms" << std::defaultfloat << "\n";
+
+        for (const Timing& timing : timings) {
+            if (!timing.passed) {
+                std::cout << "FAILED TEST: " << timing.test << "\n";
+            }
+        }
+
+        std::sort(timings.begin(), timings.end(),
+                  [](const Timing& a, const Timing& b) { return a.ms > b.ms; });
+        if (slowest > 0 && !timings.empty()) {
+            std::cout << "Slowest tests:\n";
+            for (size_t i = 0; i < slowest && i < timings.size(); ++i) {
+                std::cout << "  " << std::fixed << std::setprecision(3) << std::setw(10) << timings[i].ms
+                          << " ms  " << timings[i].test << std::defaultfloat << "\n";
+            }
+        }
+        return passed;
+    }
+};
 
 // Test assertion macros
 #define TEST_MESSAGE(condition, message) \
     do { \
         TestFixture::IncrementTotal(); \
         if (!(condition)) { \
-            std::cout << "FAILED: " << message << " [" << __FILE__ << ":" << __LINE__ << "]" << std::endl; \
+            TestFixture::Out() << "FAILED: " << message << " [" << __FILE__ << ":" << __LINE__ << "]" << std::endl; \
         } else { \
             TestFixture::IncrementPassed(); \
             if (TestFixture::Verbose) { \
-                std::cout << "PASSED: " << message << std::endl; \
+                TestFixture::Out() << "PASSED: " << message << std::endl; \
             } \
         } \
     } while(0)
@@ -54,16 +333,16 @@ int TestFixture::totalTests = 0;
     do { \
         TestFixture::IncrementTotal(); \
         if (!((actual) == (expected))) { \
-            std::cout << "FAILED: " << message << "\n" \
+            TestFixture::Out() << "FAILED: " << message << "\n" \
                      << "Expected: " << (expected) << "\n" \
                      << "Actual: " << (actual) << "\n" \
                      << "[" << __FILE__ << ":" << __LINE__ << "]" << std::endl; \
         } else { \
             TestFixture::IncrementPassed(); \
             if (TestFixture::Verbose) { \
-                std::cout << "PASSED: " << message << std::endl; \
+                TestFixture::Out() << "PASSED: " << message << std::endl; \
             } \
         } \
     } while(0)
 
-#endif // SIMPLETEST_H 
\ No newline at end of file
+#endif // SIMPLETEST_H
@@ -0,0 +1,200 @@
+#ifndef SIZE_CLASS_ALLOCATOR_HPP
+#define SIZE_CLASS_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "chained_arena.hpp"
+
+// Small-object allocator with power-of-two size classes from MinSize to
+// MaxSize. Each class carves ChunkSize-byte chunks from a chained bump arena
+// and keeps its own intrusive free list, so blocks can be freed one at a
+// time. Frees are sized (no per-block header); requests above MaxSize fail.
+template<size_t MaxSize = 1024, size_t ChunkSize = 16 * 1024, size_t MinSize = 8>
+class SizeClassAllocator {
+    static_assert((MinSize & (MinSize - 1)) == 0 && MinSize >= sizeof(void*),
+                  "MinSize must be a power of two that can hold a free-list link");
+    static_assert((MaxSize & (MaxSize - 1)) == 0 && MaxSize >= MinSize,
+                  "MaxSize must be a power of two no smaller than MinSize");
+    static_assert(ChunkSize >= MaxSize, "A chunk must hold at least one block of every class");
+
+public:
+    // Occupancy of one size class
+    struct ClassStats {
+        size_t block_size;     // Bytes per block
+        size_t live;           // Blocks currently allocated
+        size_t free;           // Blocks on the free list
+        size_t chunks;         // Chunks carved for this class
+    };
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        FreeBlock* free;       // Intrusive list of freed blocks
+        char* bump;            // Next never-used block in the newest chunk
+        char* bump_end;        // End of the newest chunk
+        size_t live;
+        size_t free_count;
+        size_t chunks;
+    };
+
+    static constexpr size_t log2(size_t value) {
+        size_t result = 0;
+        while (value > 1) {
+            value >>= 1;
+            ++result;
+        }
+        return result;
+    }
+
+    static constexpr size_t MIN_SHIFT = log2(MinSize);
+    static constexpr size_t CLASS_COUNT = log2(MaxSize) - MIN_SHIFT + 1;
+
+    ChainedBumpAllocator<> chunks_;
+    SizeClass classes_[CLASS_COUNT];
+    size_t allocations_;
+
+    // Smallest class whose block size covers `size`
+    static size_t class_index(size_t size) {
+        if (size <= MinSize) {
+            return 0;
+        }
+#if defined(__GNUC__) || defined(__clang__)
+        size_t shift = 64 - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(size - 1)));
+#else
+        size_t shift = log2(size - 1) + 1;
+#endif
+        return shift - MIN_SHIFT;
+    }
+
+    bool refill(SizeClass& size_class, size_t block_size) {
+        // Aligning the chunk to the block size aligns every block in it
+        size_t align = block_size < 4096 ? block_size : 4096;
+        char* chunk = static_cast<char*>(chunks_.alloc_aligned(ChunkSize, align));
+        if (chunk == nullptr) {
+            return false;
+        }
+        size_class.bump = chunk;
+        size_class.bump_end = chunk + ChunkSize - ChunkSize % block_size;
+        ++size_class.chunks;
+        return true;
+    }
+
+    void clear_classes() {
+        for (SizeClass& size_class : classes_) {
+            size_class = SizeClass{nullptr, nullptr, nullptr, 0, 0, 0};
+        }
+        allocations_ = 0;
+    }
+
+public:
+    SizeClassAllocator() : chunks_(ChunkSize * 4, ChunkSize * 64), allocations_(0) {
+        clear_classes();
+    }
+
+    SizeClassAllocator(const SizeClassAllocator&) = delete;
+    SizeClassAllocator& operator=(const SizeClassAllocator&) = delete;
+
+    template<typename T>
+    T* alloc(size_t n = 1) {
+        // Guard against sizeof(T) * n overflowing
+        if (n > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(alloc_aligned(sizeof(T) * n, alignof(T)));
+    }
+
+    // Blocks are aligned to their class size (capped at 4096), so alignment
+    // is met by rounding the request up to `align`
+    void* alloc_aligned(size_t size, size_t align) {
+        if (align == 0 || (align & (align - 1)) != 0 || align > 4096) {
+            return nullptr;
+        }
+        if (size < align) {
+            size = align;
+        }
+        if (size > MaxSize) {
+            return nullptr;
+        }
+
+        size_t index = class_index(size);
+        SizeClass& size_class = classes_[index];
+
+        void* result = size_class.free;
+        if (result != nullptr) {
+            size_class.free = size_class.free->next;
+            --size_class.free_count;
+        } else {
+            size_t block_size = MinSize << index;
+            if (size_class.bump == size_class.bump_end && !refill(size_class, block_size)) {
+                return nullptr;
+            }
+            result = size_class.bump;
+            size_class.bump += block_size;
+        }
+
+        ++size_class.live;
+        ++allocations_;
+        return result;
+    }
+
+    // Return a block; `size` and `align` must match the allocation
+    void dealloc(void* ptr, size_t size, size_t align = 1) {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (size < align) {
+            size = align;
+        }
+
+        SizeClass& size_class = classes_[class_index(size)];
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = size_class.free;
+        size_class.free = block;
+        ++size_class.free_count;
+        --size_class.live;
+        --allocations_;
+    }
+
+    // Drop every allocation and recycle all chunks
+    void reset() {
+        chunks_.reset();
+        clear_classes();
+    }
+
+    static constexpr size_t max_size() {
+        return MaxSize;
+    }
+
+    static constexpr size_t class_count() {
+        return CLASS_COUNT;
+    }
+
+    // Method to get the occupancy of size class `index`
+    ClassStats class_stats(size_t index) const {
+        const SizeClass& size_class = classes_[index];
+        return ClassStats{MinSize << index, size_class.live, size_class.free_count,
+                          size_class.chunks};
+    }
+
+    // Method to get current number of allocations
+    size_t allocations() const {
+        return allocations_;
+    }
+
+    // Method to get bytes available across all classes without a new chunk
+    size_t remaining_space() const {
+        size_t total = 0;
+        for (size_t i = 0; i < CLASS_COUNT; ++i) {
+            const SizeClass& size_class = classes_[i];
+            total += size_class.free_count * (MinSize << i) +
+                     static_cast<size_t>(size_class.bump_end - size_class.bump);
+        }
+        return total;
+    }
+};
+
+#endif // SIZE_CLASS_ALLOCATOR_HPP
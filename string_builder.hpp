@@ -0,0 +1,199 @@
+#ifndef STRING_BUILDER_HPP
+#define STRING_BUILDER_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+
+#include "my_string.hpp"
+
+// Rope of string pieces over a bump allocator that is materialized once.
+// append() records a reference, so the characters must stay valid until the
+// last build(); append_copy(), append(char) and append_number() copy into the
+// arena first. The first InlinePieces references live in the builder, later
+// ones in 32-piece chunks from the arena. build() and build_slice() allocate
+// exactly size() + 1 bytes and copy each piece once. Exhaustion throws
+// std::bad_alloc.
+template<typename Allocator, size_t InlinePieces = 32>
+class StringBuilder {
+private:
+    static constexpr size_t CHUNK_PIECES = 32;
+
+    // Trivial, so neither the builder nor a chunk initializes its slots
+    struct Piece {
+        const char* data;
+        size_t size;
+    };
+
+    struct Chunk {
+        Chunk* next;
+        size_t count;
+        Piece pieces[CHUNK_PIECES];
+    };
+
+    Allocator& allocator_;
+    Piece inline_[InlinePieces];
+    size_t inline_count_;      // Pieces used in inline_
+    Chunk* head_;              // First arena chunk, once inline_ is full
+    Chunk* tail_;              // Chunk being filled
+    size_t size_;              // Total characters
+
+    char* allocate(size_t size) const {
+        void* memory = allocator_.alloc_aligned(size, 1);
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<char*>(memory);
+    }
+
+    void push(Piece piece) {
+        if (inline_count_ < InlinePieces) {
+            inline_[inline_count_++] = piece;
+        } else {
+            if (tail_ == nullptr || tail_->count == CHUNK_PIECES) {
+                void* memory = allocator_.alloc_aligned(sizeof(Chunk), alignof(Chunk));
+                if (memory == nullptr) {
+                    throw std::bad_alloc();
+                }
+                Chunk* chunk = new (memory) Chunk;
+                chunk->next = nullptr;
+                chunk->count = 0;
+                if (tail_ != nullptr) {
+                    tail_->next = chunk;
+                } else {
+                    head_ = chunk;
+                }
+                tail_ = chunk;
+            }
+            tail_->pieces[tail_->count++] = piece;
+        }
+        size_ += piece.size;
+    }
+
+    // Most pieces are a few bytes, where a memcpy() call costs more than
+    // the copy; two overlapping fixed-size copies cover them inline
+    static void copy_piece(char* out, const char* source, size_t n) {
+        if (n >= 8 && n <= 16) {
+            std::memcpy(out, source, 8);
+            std::memcpy(out + n - 8, source + n - 8, 8);
+        } else if (n >= 4 && n < 8) {
+            std::memcpy(out, source, 4);
+            std::memcpy(out + n - 4, source + n - 4, 4);
+        } else if (n < 4) {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = source[i];
+            }
+        } else {
+            std::memcpy(out, source, n);
+        }
+    }
+
+public:
+    explicit StringBuilder(Allocator& allocator)
+        : allocator_(allocator), inline_count_(0), head_(nullptr), tail_(nullptr), size_(0) {}
+
+    StringBuilder(const StringBuilder&) = delete;
+    StringBuilder& operator=(const StringBuilder&) = delete;
+
+    // Reference `piece` without copying it
+    StringBuilder& append(std::string_view piece) {
+        if (!piece.empty()) {
+            push(Piece{piece.data(), piece.size()});
+        }
+        return *this;
+    }
+
+    // Copy `piece` into the arena, for characters that do not outlive the
+    // builder
+    StringBuilder& append_copy(std::string_view piece) {
+        if (!piece.empty()) {
+            char* copy = allocate(piece.size());
+            std::memcpy(copy, piece.data(), piece.size());
+            push(Piece{copy, piece.size()});
+        }
+        return *this;
+    }
+
+    StringBuilder& append(char ch) {
+        return append_copy(std::string_view(&ch, 1));
+    }
+
+    template<typename T>
+    StringBuilder& append_number(T value) {
+        static_assert(std::is_integral_v<T>, "append_number() formats integers");
+        char digits[24];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        return append_copy(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+    // Call f(StringSlice) for every piece in order
+    template<typename F>
+    void for_each_piece(F f) const {
+        for (size_t i = 0; i < inline_count_; ++i) {
+            f(StringSlice(inline_[i].data, inline_[i].size));
+        }
+        for (const Chunk* chunk = head_; chunk != nullptr; chunk = chunk->next) {
+            for (size_t i = 0; i < chunk->count; ++i) {
+                f(StringSlice(chunk->pieces[i].data, chunk->pieces[i].size));
+            }
+        }
+    }
+
+    // Copy every piece to `out`, which must hold size() characters
+    void copy_to(char* out) const {
+        for_each_piece([&out](StringSlice piece) {
+            copy_piece(out, piece.data(), piece.size());
+            out += piece.size();
+        });
+    }
+
+    // Materialize into a string drawing from the same arena. Results of up
+    // to MyString::inline_capacity() characters allocate nothing.
+    ArenaString<Allocator> build() const {
+        ArenaString<Allocator> result{ArenaStringResource<Allocator>(allocator_)};
+        result.reserve(size_);
+        for_each_piece([&result](StringSlice piece) {
+            result.append(piece.view());
+        });
+        return result;
+    }
+
+    // Materialize into a NUL-terminated arena buffer, valid until the arena
+    // is reset or rewound
+    StringSlice build_slice() const {
+        char* buffer = allocate(size_ + 1);
+        copy_to(buffer);
+        buffer[size_] = '\0';
+        return StringSlice(buffer, size_);
+    }
+
+    // Forget every piece; arena chunks are reclaimed with the arena
+    void clear() {
+        inline_count_ = 0;
+        head_ = tail_ = nullptr;
+        size_ = 0;
+    }
+
+    // Method to get the total length of the pieces
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    // Method to get the number of pieces
+    size_t pieces() const {
+        size_t count = inline_count_;
+        for (const Chunk* chunk = head_; chunk != nullptr; chunk = chunk->next) {
+            count += chunk->count;
+        }
+        return count;
+    }
+};
+
+#endif // STRING_BUILDER_HPP
@@ -1,56 +1,426 @@
 #ifndef BUMP_ALLOCATOR_HPP
 #define BUMP_ALLOCATOR_HPP
 
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
 
-template<size_t N>
-class BumpAllocator {
+#include "arena_instrument.hpp"
+#include "arena_storage.hpp"
+
+// Pre-checked range handed out by BumpResource::reserve(). take() only aligns
+// and bumps; callers must stay within the bytes they reserved.
+class BumpSpan {
 private:
-    char memory_[N];           // Fixed size memory chunk
+    char* next_;
+    char* end_;
+
+public:
+    BumpSpan() : next_(nullptr), end_(nullptr) {}
+    BumpSpan(char* begin, char* end) : next_(begin), end_(end) {}
+
+    template<typename T>
+    T* take(size_t n = 1) {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(next_);
+        char* result = next_ + (static_cast<size_t>(-addr) & (alignof(T) - 1));
+        next_ = result + sizeof(T) * n;
+        assert(next_ <= end_ && "BumpSpan overrun");
+        return reinterpret_cast<T*>(result);
+    }
+
+    explicit operator bool() const {
+        return next_ != nullptr;
+    }
+
+    size_t remaining() const {
+        return static_cast<size_t>(end_ - next_);
+    }
+};
+
+// Bump allocator over a caller-provided range. This is the shared fast path
+// for the compile-time BumpAllocator<N> and the runtime-sized BumpArena, so
+// either can be passed around as a BumpResource& without templating callers
+// on N. Instrument is a policy from arena_instrument.hpp; the default
+// NoInstrumentation leaves the fast path untouched.
+template<typename Instrument = NoInstrumentation>
+class BasicBumpResource : private Instrument {
+private:
+    // Record for objects from create()/create_array() that need their
+    // destructors run. Stored in the arena just ahead of the objects.
+    struct Destructor {
+        void (*destroy)(Destructor* node);
+        size_t count;
+        Destructor* prev;
+    };
+
+    template<typename T>
+    static constexpr size_t objects_offset() {
+        return (sizeof(Destructor) + alignof(T) - 1) & ~(alignof(T) - 1);
+    }
+
+    template<typename T>
+    static T* objects_of(Destructor* node) {
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(node) + objects_offset<T>());
+    }
+
+    template<typename T>
+    static void destroy_objects(Destructor* node) {
+        T* objects = std::launder(objects_of<T>(node));
+        for (size_t i = node->count; i > 0; --i) {
+            objects[i - 1].~T();
+        }
+    }
+
+    // Allocate a Destructor record followed by room for n objects of T
+    template<typename T>
+    Destructor* alloc_with_destructor(size_t n, CallSite site) {
+        constexpr size_t offset = objects_offset<T>();
+        constexpr size_t align = alignof(T) > alignof(Destructor) ? alignof(T) : alignof(Destructor);
+        if (n > (SIZE_MAX - offset) / sizeof(T)) {
+            if constexpr (Instrument::enabled) {
+                Instrument::on_failure(SIZE_MAX, align, site);
+            }
+            return nullptr;
+        }
+        return static_cast<Destructor*>(alloc_aligned(offset + sizeof(T) * n, align, site));
+    }
+
+    void push_destructor(Destructor* node, void (*destroy)(Destructor*), size_t count) {
+        node->destroy = destroy;
+        node->count = count;
+        node->prev = destructors_;
+        destructors_ = node;
+    }
+
+protected:
+    char* memory_;             // Start of the chunk
+    char* end_;                // End of the chunk
     char* next_;               // Bump pointer
     size_t allocations_;       // Counter for allocations
+    size_t padding_waste_;     // Bytes skipped to satisfy alignment
+    Destructor* destructors_;  // Newest pending destructor record
+
+    BasicBumpResource(char* memory, size_t capacity)
+        : memory_(memory), end_(memory + capacity), next_(memory),
+          allocations_(0), padding_waste_(0), destructors_(nullptr) {
+        if constexpr (Instrument::enabled) {
+            Instrument::on_attach(memory_, capacity);
+        }
+    }
+
+    // Hand the buffer back from the policy before it is freed. Derived
+    // classes that free the buffer themselves call this first; it is a
+    // no-op the second time.
+    void detach() {
+        if constexpr (Instrument::enabled) {
+            Instrument::on_detach(memory_, capacity());
+            next_ = end_ = memory_;
+        }
+    }
+
+    // Run pending destructors, newest first, back to `stop`
+    void destroy_until(Destructor* stop) {
+        while (destructors_ != stop) {
+            Destructor* node = destructors_;
+            destructors_ = node->prev;
+            node->destroy(node);
+        }
+    }
+
+    // Hook for storage that can hand touched pages back on reset()
+    virtual void discard(size_t /*used*/) {}
 
 public:
-    BumpAllocator() : next_(memory_), allocations_(0) {}
+    // Checkpoint returned by mark() and restored by rewind()
+    struct Marker {
+        char* position;
+        size_t allocations;
+        size_t padding_waste;
+        Destructor* destructors;
+    };
+
+    BasicBumpResource(const BasicBumpResource&) = delete;
+    BasicBumpResource& operator=(const BasicBumpResource&) = delete;
+
+    virtual ~BasicBumpResource() {
+        destroy_until(nullptr);
+        detach();
+    }
 
+    // `site` is filled in at the call site for instrumentation; leave it
+    // defaulted
     template<typename T>
-    T* alloc(size_t n = 1) {
-        // Calculate total size needed
-        size_t size = sizeof(T) * n;
-        
-        // Check if we have enough space
-        if (next_ + size > memory_ + N) {
+    T* alloc(size_t n = 1, CallSite site = CallSite::current()) {
+        // Guard against sizeof(T) * n overflowing
+        if (n > SIZE_MAX / sizeof(T)) {
+            if constexpr (Instrument::enabled) {
+                Instrument::on_failure(SIZE_MAX, alignof(T), site);
+            }
             return nullptr;
         }
+        return static_cast<T*>(alloc_aligned(sizeof(T) * n, alignof(T), site));
+    }
+
+    // Allocate raw bytes at an explicit power-of-two alignment (e.g. 32/64
+    // for SIMD loads or cache-line-aligned buffers)
+    void* alloc_aligned(size_t size, size_t align, CallSite site = CallSite::current()) {
+        if (align == 0 || (align & (align - 1)) != 0) {
+            if constexpr (Instrument::enabled) {
+                Instrument::on_failure(size, align, site);
+            }
+            return nullptr;
+        }
+
+        // Padding needed to round the bump pointer up to the alignment
+        uintptr_t addr = reinterpret_cast<uintptr_t>(next_);
+        size_t padding = static_cast<size_t>(-addr) & (align - 1);
+
+        // Check if we have enough space, including any policy redzone
+        size_t remaining = remaining_space();
+        if (padding > remaining || size > remaining - padding ||
+            Instrument::redzone > remaining - padding - size) {
+            if constexpr (Instrument::enabled) {
+                Instrument::on_failure(size, align, site);
+            }
+            return nullptr;
+        }
+
+        // Save current (aligned) position
+        char* result = next_ + padding;
 
-        // Save current position
-        T* result = reinterpret_cast<T*>(next_);
-        
         // Bump the pointer
-        next_ += size;
-        
+        next_ = result + size + Instrument::redzone;
+        padding_waste_ += padding;
+
         // Increment allocation counter
         ++allocations_;
-        
+
+        if constexpr (Instrument::enabled) {
+            Instrument::on_alloc(result, size, align, padding, used(), site);
+        }
         return result;
     }
 
+    // Grow the block at `ptr` from old_size to new_size bytes in place.
+    // Succeeds only if it is the most recent allocation and the extra bytes
+    // fit; otherwise nothing changes and the caller must move the data.
+    // Instrumented arenas never extend, so every block keeps the guard and
+    // statistics it was allocated with.
+    bool extend(void* ptr, size_t old_size, size_t new_size) {
+        if constexpr (Instrument::enabled) {
+            return false;
+        }
+        char* block = static_cast<char*>(ptr);
+        if (block == nullptr || block + old_size != next_ || new_size < old_size ||
+            new_size - old_size > remaining_space()) {
+            return false;
+        }
+        next_ = block + new_size;
+        return true;
+    }
+
+    // Allocate `count` objects of T with a single bounds check, writing their
+    // addresses to `out`. All-or-nothing: returns false and allocates nothing
+    // if the batch does not fit. Each object counts as one allocation.
+    template<typename T>
+    bool alloc_batch(size_t count, T** out, CallSite site = CallSite::current()) {
+        if (count == 0) {
+            return true;
+        }
+        if (count > SIZE_MAX / sizeof(T)) {
+            if constexpr (Instrument::enabled) {
+                Instrument::on_failure(SIZE_MAX, alignof(T), site);
+            }
+            return false;
+        }
+        T* base = static_cast<T*>(alloc_aligned(sizeof(T) * count, alignof(T), site));
+        if (base == nullptr) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = base + i;
+        }
+        allocations_ += count - 1;
+        return true;
+    }
+
+    // Reserve `size` bytes to be carved later without bounds checks. Returns
+    // an empty span if the reservation does not fit. The whole span counts as
+    // one allocation.
+    BumpSpan reserve(size_t size, size_t align = alignof(std::max_align_t),
+                     CallSite site = CallSite::current()) {
+        char* begin = static_cast<char*>(alloc_aligned(size, align, site));
+        if (begin == nullptr) {
+            return BumpSpan();
+        }
+        return BumpSpan(begin, begin + size);
+    }
+
+    // Construct a T in arena memory. Types with a non-trivial destructor
+    // get a destructor record that reset(), rewind() or the last dealloc()
+    // runs; trivially destructible types are a plain bump. Returns nullptr
+    // if the arena is full. A variadic pack cannot be followed by a
+    // defaulted CallSite, so up to four constructor arguments get their own
+    // overload that records the caller's site (pass a CallSite last to name
+    // one); longer argument lists are recorded at create_at().
+    template<typename T>
+    T* create(CallSite site = CallSite::current()) {
+        return create_at<T>(site);
+    }
+
+    template<typename T, typename A0>
+    T* create(A0&& a0, CallSite site = CallSite::current()) {
+        return create_at<T>(site, std::forward<A0>(a0));
+    }
+
+    template<typename T, typename A0, typename A1>
+    T* create(A0&& a0, A1&& a1, CallSite site = CallSite::current()) {
+        return create_at<T>(site, std::forward<A0>(a0), std::forward<A1>(a1));
+    }
+
+    template<typename T, typename A0, typename A1, typename A2>
+    T* create(A0&& a0, A1&& a1, A2&& a2, CallSite site = CallSite::current()) {
+        return create_at<T>(site, std::forward<A0>(a0), std::forward<A1>(a1), std::forward<A2>(a2));
+    }
+
+    template<typename T, typename A0, typename A1, typename A2, typename A3>
+    T* create(A0&& a0, A1&& a1, A2&& a2, A3&& a3, CallSite site = CallSite::current()) {
+        return create_at<T>(site, std::forward<A0>(a0), std::forward<A1>(a1), std::forward<A2>(a2),
+                            std::forward<A3>(a3));
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        return create_at<T>(CallSite::current(), std::forward<Args>(args)...);
+    }
+
+    // create() with an explicit call site
+    template<typename T, typename... Args>
+    T* create_at(CallSite site, Args&&... args) {
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            T* object = alloc<T>(1, site);
+            if (object == nullptr) {
+                return nullptr;
+            }
+            return new (object) T(std::forward<Args>(args)...);
+        } else {
+            Destructor* node = alloc_with_destructor<T>(1, site);
+            if (node == nullptr) {
+                return nullptr;
+            }
+            T* object = new (objects_of<T>(node)) T(std::forward<Args>(args)...);
+            push_destructor(node, destroy_objects<T>, 1);
+            return object;
+        }
+    }
+
+    // Element count for create_array(). Converting to it at the call
+    // records the caller's site ahead of the variadic arguments; pass
+    // {n, site} to name one explicitly.
+    struct ArrayCount {
+        size_t n;
+        CallSite site;
+
+        ArrayCount(size_t count, CallSite at = CallSite::current()) : n(count), site(at) {}
+    };
+
+    // Construct n objects of T, each from `args`. If a constructor throws,
+    // the elements already built are destroyed and the exception propagates.
+    template<typename T, typename... Args>
+    T* create_array(ArrayCount count, const Args&... args) {
+        size_t n = count.n;
+        T* objects;
+        Destructor* node = nullptr;
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            objects = alloc<T>(n, count.site);
+        } else {
+            node = alloc_with_destructor<T>(n, count.site);
+            objects = node != nullptr ? objects_of<T>(node) : nullptr;
+        }
+        if (objects == nullptr) {
+            return nullptr;
+        }
+
+        size_t built = 0;
+        try {
+            for (; built < n; ++built) {
+                new (objects + built) T(args...);
+            }
+        } catch (...) {
+            while (built > 0) {
+                objects[--built].~T();
+            }
+            throw;
+        }
+
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            push_destructor(node, destroy_objects<T>, n);
+        }
+        return std::launder(objects);
+    }
+
     void dealloc() {
         // Decrement allocation counter
         if (allocations_ > 0) {
             --allocations_;
-            
+
             // If all allocations are freed, reset the bump pointer
             if (allocations_ == 0) {
+                destroy_until(nullptr);
+                if constexpr (Instrument::enabled) {
+                    Instrument::on_release(memory_, next_, 0);
+                }
                 next_ = memory_;
+                padding_waste_ = 0;
+            }
+            if constexpr (Instrument::enabled) {
+                Instrument::on_dealloc(used());
             }
         }
     }
 
-    // Static method to get the total capacity
-    static constexpr size_t capacity() {
-        return N;
+    // Drop all allocations and let the storage release touched pages
+    void reset() {
+        destroy_until(nullptr);
+        if constexpr (Instrument::enabled) {
+            Instrument::on_release(memory_, next_, 0);
+        }
+        discard(used());
+        next_ = memory_;
+        allocations_ = 0;
+        padding_waste_ = 0;
+    }
+
+    // Record the current bump position
+    Marker mark() const {
+        return Marker{next_, allocations_, padding_waste_, destructors_};
+    }
+
+    // Release everything allocated since `marker` was taken, destroying
+    // objects created since then. Markers must be rewound in LIFO order.
+    void rewind(const Marker& marker) {
+        destroy_until(marker.destructors);
+        if constexpr (Instrument::enabled) {
+            Instrument::on_release(marker.position, next_,
+                                   static_cast<size_t>(marker.position - memory_));
+        }
+        next_ = marker.position;
+        allocations_ = marker.allocations;
+        padding_waste_ = marker.padding_waste;
+    }
+
+    // Method to get the total capacity
+    size_t capacity() const {
+        return static_cast<size_t>(end_ - memory_);
+    }
+
+    // Method to get bytes in use, including alignment padding
+    size_t used() const {
+        return static_cast<size_t>(next_ - memory_);
     }
 
     // Method to get current number of allocations
@@ -60,8 +430,104 @@ public:
 
     // Method to get remaining space
     size_t remaining_space() const {
-        return N - (next_ - memory_);
+        return static_cast<size_t>(end_ - next_);
+    }
+
+    // Method to get bytes lost to alignment padding since the last reset
+    size_t padding_waste() const {
+        return padding_waste_;
+    }
+
+    // Method to get the instrumentation policy instance
+    const Instrument& instrumentation() const {
+        return *this;
+    }
+
+    Instrument& instrumentation() {
+        return *this;
+    }
+};
+
+using BumpResource = BasicBumpResource<>;
+
+// Storage selects where the N-byte chunk lives: InlineStorage (inside the
+// object), HeapStorage, or MmapStorage/HugePageStorage
+template<size_t N, template<size_t> class Storage = InlineStorage,
+         typename Instrument = NoInstrumentation>
+class BumpAllocator : private BumpStorageHolder<Storage<N>>, public BasicBumpResource<Instrument> {
+private:
+    using Holder = BumpStorageHolder<Storage<N>>;
+    using Base = BasicBumpResource<Instrument>;
+
+protected:
+    void discard(size_t used) override {
+        Holder::storage_.discard(used);
+    }
+
+public:
+    BumpAllocator() : Base(Holder::storage_.data(), N) {}
+
+    // Static method to get the total capacity
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    // Method to get the storage policy instance
+    const Storage<N>& storage() const {
+        return Holder::storage_;
+    }
+};
+
+// Bump allocator whose capacity is chosen at runtime. Owns a heap buffer or
+// borrows a caller-provided one.
+template<typename Instrument = NoInstrumentation>
+class BasicBumpArena : public BasicBumpResource<Instrument> {
+private:
+    bool owns_;                // Buffer was allocated by this arena
+
+    static char* allocate_buffer(size_t capacity) {
+        void* buffer = std::malloc(capacity ? capacity : 1);
+        if (buffer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<char*>(buffer);
+    }
+
+public:
+    explicit BasicBumpArena(size_t capacity)
+        : BasicBumpResource<Instrument>(allocate_buffer(capacity), capacity), owns_(true) {}
+
+    BasicBumpArena(void* buffer, size_t capacity)
+        : BasicBumpResource<Instrument>(static_cast<char*>(buffer), capacity), owns_(false) {}
+
+    ~BasicBumpArena() override {
+        this->destroy_until(nullptr);
+        this->detach();
+        if (owns_) {
+            std::free(this->memory_);
+        }
+    }
+};
+
+using BumpArena = BasicBumpArena<>;
+
+// RAII guard that rewinds an allocator to where it stood on construction
+template<typename Allocator>
+class ArenaScope {
+private:
+    Allocator& allocator_;
+    typename Allocator::Marker marker_;
+
+public:
+    explicit ArenaScope(Allocator& allocator)
+        : allocator_(allocator), marker_(allocator.mark()) {}
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    ~ArenaScope() {
+        allocator_.rewind(marker_);
     }
 };
 
-#endif // BUMP_ALLOCATOR_HPP 
\ No newline at end of file
+#endif // BUMP_ALLOCATOR_HPP
\ No newline at end of file
@@ -1,34 +1,54 @@
 #include "task1.hpp"
+#include "chained_arena.hpp"
+#include "concurrent_arena.hpp"
+#include "bump_resource.hpp"
+#include "pool_allocator.hpp"
+#include "size_class_allocator.hpp"
+#include "alloc_trace.hpp"
+#include "double_ended_arena.hpp"
+#include "fiber_stack.hpp"
+#include "fiber_context.hpp"
+#include "fiber_scheduler.hpp"
+#include "fiber_io.hpp"
+#include "work_stealing_deque.hpp"
+#include "my_string.hpp"
+#include "string_simd.hpp"
+#include "string_builder.hpp"
 #include <simpletest.h>
+#include "perf_assert.hpp"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <csignal>
+#ifdef ARENA_STORAGE_HAS_MMAP
+#include <sys/wait.h>
+#include <sys/un.h>
+#endif
 
-// Forward declarations of test functions
-void TEST_BasicAllocation_BumpAllocator();
-void TEST_AllocationFailure_BumpAllocator();
-void TEST_MultipleAllocations_BumpAllocator();
-void TEST_DeallocationReset_BumpAllocator();
-void TEST_RemainingSpace_BumpAllocator();
-
-// Test group definitions
-struct TestGroup {
-    const char* name;
-    std::vector<std::function<void()>> tests;
-};
+// Upstream that counts block requests so tests can observe recycling
+struct CountingUpstream {
+    static size_t allocated;
+    static size_t deallocated;
 
-TestGroup test_groups[] = {
-    {
-        "BumpAllocator",
-        {
-            TEST_BasicAllocation_BumpAllocator,
-            TEST_AllocationFailure_BumpAllocator,
-            TEST_MultipleAllocations_BumpAllocator,
-            TEST_DeallocationReset_BumpAllocator,
-            TEST_RemainingSpace_BumpAllocator
-        }
+    static void* allocate(size_t size) {
+        ++allocated;
+        return MallocUpstream::allocate(size);
+    }
+
+    static void deallocate(void* ptr, size_t size) {
+        ++deallocated;
+        MallocUpstream::deallocate(ptr, size);
     }
 };
 
+size_t CountingUpstream::allocated = 0;
+size_t CountingUpstream::deallocated = 0;
+
 // Test basic allocation
 DEFINE_TEST_G(BasicAllocation, BumpAllocator) {
     BumpAllocator<1024> allocator;
@@ -123,20 +143,2002 @@ DEFINE_TEST_G(RemainingSpace, BumpAllocator) {
                "Remaining space should decrease by sizeof(int)");
     
     double* d = allocator.alloc<double>();
-    TEST_EQUAL(allocator.remaining_space(), initial_space - sizeof(int) - sizeof(double),
-               "Remaining space should decrease by sizeof(double)");
+    TEST_EQUAL(allocator.remaining_space(),
+               initial_space - sizeof(int) - sizeof(double) - allocator.padding_waste(),
+               "Remaining space should decrease by sizeof(double) plus alignment padding");
+}
+
+// Test that typed allocations honor alignof(T)
+DEFINE_TEST_G(TypeAlignment, BumpAllocator) {
+    BumpAllocator<100> allocator;
+    
+    char* c = allocator.alloc<char>();
+    double* d = allocator.alloc<double>();
+    
+    TEST_MESSAGE(c != nullptr, "Char allocation should succeed");
+    TEST_MESSAGE(d != nullptr, "Double allocation should succeed");
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(d) % alignof(double), 0,
+               "Double should be aligned to alignof(double)");
+    TEST_EQUAL(allocator.padding_waste(), alignof(double) - sizeof(char),
+               "Padding waste should account for the bytes skipped after the char");
+    
+    allocator.dealloc();
+    allocator.dealloc();
+    TEST_EQUAL(allocator.padding_waste(), 0, "Padding waste should reset with the allocator");
+}
+
+// Test explicit over-aligned allocations
+DEFINE_TEST_G(AlignedAllocation, BumpAllocator) {
+    BumpAllocator<256> allocator;
+    
+    allocator.alloc<char>();
+    void* simd = allocator.alloc_aligned(32, 32);
+    void* line = allocator.alloc_aligned(64, 64);
+    
+    TEST_MESSAGE(simd != nullptr, "32-byte aligned allocation should succeed");
+    TEST_MESSAGE(line != nullptr, "64-byte aligned allocation should succeed");
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(simd) % 32, 0, "Pointer should be 32-byte aligned");
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(line) % 64, 0, "Pointer should be 64-byte aligned");
+    
+    TEST_MESSAGE(allocator.alloc_aligned(8, 3) == nullptr,
+                 "Non power-of-two alignment should be rejected");
+    TEST_EQUAL(allocator.allocations(), 3, "Rejected allocation should not be counted");
+    
+    BumpAllocator<64> small_allocator;
+    small_allocator.alloc<char>();
+    TEST_MESSAGE(small_allocator.alloc_aligned(64, 64) == nullptr,
+                 "Allocation should fail when padding pushes it past capacity");
+}
+
+// Test that heap storage keeps the buffer outside the allocator object
+DEFINE_TEST_G(HeapStorage, BumpAllocator) {
+    BumpAllocator<1024 * 1024, HeapStorage> allocator;
+    
+    TEST_MESSAGE(sizeof(allocator) < 1024, "Heap-backed allocator should not embed its buffer");
+    
+    char* buffer = allocator.alloc<char>(1024 * 1024);
+    TEST_MESSAGE(buffer != nullptr, "Should be able to allocate the full heap buffer");
+    if (buffer != nullptr) {
+        buffer[1024 * 1024 - 1] = 'z';
+        TEST_EQUAL(buffer[1024 * 1024 - 1], 'z', "Last byte of the heap buffer should be writable");
+    }
+    TEST_EQUAL(allocator.remaining_space(), 0, "Heap buffer should be exhausted");
+}
+
+// Test mmap-backed storage and that reset hands pages back to the OS
+DEFINE_TEST_G(MmapStorage, BumpAllocator) {
+#ifdef ARENA_STORAGE_HAS_MMAP
+    BumpAllocator<64 * 1024, MmapStorage> allocator;
+    
+    int* values = allocator.alloc<int>(1024);
+    TEST_MESSAGE(values != nullptr, "Mmap-backed allocation should succeed");
+    if (values != nullptr) {
+        values[0] = 42;
+        allocator.reset();
+        TEST_EQUAL(allocator.remaining_space(), allocator.capacity(), "Reset should reclaim all space");
+        
+        int* again = allocator.alloc<int>(1024);
+        TEST_MESSAGE(again == values, "Allocation after reset should start at the buffer base");
+        TEST_EQUAL(again[0], 0, "Discarded anonymous pages should read back as zero");
+    }
+    
+    BumpAllocator<4 * 1024 * 1024, HugePageStorage> huge_allocator;
+    void* line = huge_allocator.alloc_aligned(4096, 64);
+    TEST_MESSAGE(line != nullptr, "Huge-page storage should fall back when huge pages are unavailable");
+#else
+    TEST_MESSAGE(true, "mmap storage is not available on this platform");
+#endif
+}
+
+// Test bulk allocation with a single bounds check
+DEFINE_TEST_G(BatchAllocation, BumpAllocator) {
+    BumpAllocator<128> allocator;
+    
+    allocator.alloc<char>();
+    double* nodes[8];
+    TEST_MESSAGE(allocator.alloc_batch(8, nodes), "Batch that fits should succeed");
+    
+    bool aligned_and_contiguous = true;
+    for (int i = 0; i < 8; ++i) {
+        aligned_and_contiguous &= reinterpret_cast<uintptr_t>(nodes[i]) % alignof(double) == 0;
+        aligned_and_contiguous &= nodes[i] == nodes[0] + i;
+    }
+    TEST_MESSAGE(aligned_and_contiguous, "Batch entries should be aligned and contiguous");
+    TEST_EQUAL(allocator.allocations(), 9, "Each batch entry should count as an allocation");
+    
+    size_t space_before = allocator.remaining_space();
+    double* too_many[16];
+    TEST_MESSAGE(!allocator.alloc_batch(16, too_many), "Batch that does not fit should fail");
+    TEST_EQUAL(allocator.remaining_space(), space_before, "Failed batch should allocate nothing");
+    TEST_EQUAL(allocator.allocations(), 9, "Failed batch should not be counted");
+}
+
+// Test reserving a span and carving it without checks
+DEFINE_TEST_G(ReserveAndCarve, BumpAllocator) {
+    BumpAllocator<256> allocator;
+    
+    BumpSpan span = allocator.reserve(64);
+    TEST_MESSAGE(static_cast<bool>(span), "Reservation that fits should succeed");
+    TEST_EQUAL(allocator.remaining_space(), 256 - 64, "Reservation should consume its bytes up front");
+    TEST_EQUAL(allocator.allocations(), 1, "Reservation should count as one allocation");
+    
+    char* c = span.take<char>();
+    int* x = span.take<int>(3);
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(x) % alignof(int), 0, "Carved ints should be aligned");
+    TEST_MESSAGE(reinterpret_cast<char*>(x) > c, "Carving should bump forward");
+    TEST_EQUAL(span.remaining(), 64 - alignof(int) - 3 * sizeof(int), "Span should track carved bytes");
+    
+    TEST_MESSAGE(!allocator.reserve(1024), "Reservation beyond capacity should be empty");
+}
+
+// Test that rewind releases a finished phase while earlier allocations stay live
+DEFINE_TEST_G(MarkRewind, BumpAllocator) {
+    BumpAllocator<128> allocator;
+    
+    int* live = allocator.alloc<int>();
+    *live = 7;
+    size_t space_at_mark = allocator.remaining_space();
+    auto marker = allocator.mark();
+    
+    allocator.alloc<double>(4);
+    allocator.alloc<char>(5);
+    TEST_EQUAL(allocator.allocations(), 3, "Should have 3 allocations before rewind");
+    
+    allocator.rewind(marker);
+    TEST_EQUAL(allocator.allocations(), 1, "Rewind should drop allocations made after the mark");
+    TEST_EQUAL(allocator.remaining_space(), space_at_mark, "Rewind should restore the bump position");
+    TEST_EQUAL(*live, 7, "Allocations before the mark should be untouched");
+    
+    int* reused = allocator.alloc<int>();
+    TEST_MESSAGE(reused == live + 1, "Next allocation should reuse the rewound space");
+}
+
+// Test that ArenaScope rewinds nested phases on scope exit
+DEFINE_TEST_G(ArenaScope, BumpAllocator) {
+    BumpAllocator<256> allocator;
+    size_t initial_space = allocator.remaining_space();
+    
+    {
+        ArenaScope<BumpAllocator<256>> outer(allocator);
+        allocator.alloc<char>(64);
+        {
+            ArenaScope<BumpAllocator<256>> inner(allocator);
+            allocator.alloc<char>(64);
+            TEST_EQUAL(allocator.remaining_space(), initial_space - 128, "Both phases should be live");
+        }
+        TEST_EQUAL(allocator.remaining_space(), initial_space - 64, "Inner scope should be released");
+    }
+    TEST_EQUAL(allocator.remaining_space(), initial_space, "Outer scope should be released");
+    TEST_EQUAL(allocator.allocations(), 0, "No allocations should remain");
+}
+
+// Test that trivially destructible types are constructed with no record
+DEFINE_TEST_G(CreateTrivial, BumpAllocator) {
+    BumpAllocator<256> allocator;
+    
+    int* value = allocator.create<int>(42);
+    TEST_EQUAL(*value, 42, "create should construct from its arguments");
+    TEST_EQUAL(allocator.used(), sizeof(int), "Trivial create should be a plain bump");
+    
+    double* values = allocator.create_array<double>(4, 1.5);
+    TEST_EQUAL(values[3], 1.5, "create_array should construct every element");
+    TEST_EQUAL(allocator.allocations(), 2, "Each create should count as one allocation");
+    TEST_MESSAGE(allocator.create_array<char>(1000) == nullptr, "create should fail when the arena is full");
 }
 
-int main() {
-    bool pass = true;
+// Object that logs its destruction order
+struct TrackedObject {
+    static std::vector<int>& destroyed() {
+        static std::vector<int> order;
+        return order;
+    }
     
-    for (const auto& group : test_groups) {
-        std::cout << "\nRunning test group: " << group.name << "\n";
-        for (const auto& test : group.tests) {
-            test();
+    int id;
+    
+    explicit TrackedObject(int id_) : id(id_) {}
+    ~TrackedObject() { destroyed().push_back(id); }
+};
+
+// Test that reset, rewind and destruction run destructors newest first
+DEFINE_TEST_G(CreateDestructors, BumpAllocator) {
+    std::vector<int>& destroyed = TrackedObject::destroyed();
+    destroyed.clear();
+    {
+        BumpAllocator<1024> allocator;
+        allocator.create<TrackedObject>(1);
+        auto marker = allocator.mark();
+        allocator.create<TrackedObject>(2);
+        allocator.create_array<TrackedObject>(2, 3);
+        allocator.alloc<int>(4);
+        
+        allocator.rewind(marker);
+        TEST_EQUAL(destroyed.size(), 3, "Rewind should destroy objects created after the marker");
+        TEST_EQUAL(destroyed[0], 3, "Newest objects should be destroyed first");
+        TEST_EQUAL(destroyed[2], 2, "Oldest rewound object should be destroyed last");
+        
+        {
+            ArenaScope<BumpAllocator<1024>> scope(allocator);
+            allocator.create<TrackedObject>(5);
         }
-        pass &= TestFixture::ExecuteTestGroup(group.name, TestFixture::Verbose);
+        TEST_EQUAL(destroyed.size(), 4, "ArenaScope should destroy scoped objects");
+        
+        allocator.create<TrackedObject>(6);
+        allocator.reset();
+        TEST_EQUAL(destroyed.size(), 6, "Reset should destroy every object");
+        
+        allocator.create<TrackedObject>(7);
+        allocator.dealloc();
+        TEST_EQUAL(destroyed.size(), 7, "The last dealloc should destroy remaining objects");
+        
+        allocator.create<TrackedObject>(8);
+    }
+    TEST_EQUAL(destroyed.size(), 8, "Destroying the allocator should run pending destructors");
+    
+    destroyed.clear();
+    {
+        BumpArena arena(1024);
+        arena.create_array<TrackedObject>(3, 9);
+    }
+    TEST_EQUAL(destroyed.size(), 3, "BumpArena should destroy objects before freeing its buffer");
+}
+
+// Object whose constructor throws after a set number of instances
+struct ThrowingObject {
+    static int& budget() {
+        static int remaining = 0;
+        return remaining;
+    }
+    static int& live() {
+        static int count = 0;
+        return count;
+    }
+    
+    ThrowingObject() {
+        if (budget()-- == 0) {
+            throw std::runtime_error("constructor failed");
+        }
+        ++live();
+    }
+    ~ThrowingObject() { --live(); }
+};
+
+// Test that a throwing element constructor unwinds the array
+DEFINE_TEST_G(CreateArrayThrows, BumpAllocator) {
+    BumpAllocator<1024> allocator;
+    ThrowingObject::budget() = 2;
+    ThrowingObject::live() = 0;
+    
+    bool thrown = false;
+    try {
+        allocator.create_array<ThrowingObject>(5);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    TEST_MESSAGE(thrown, "The constructor exception should propagate");
+    TEST_EQUAL(ThrowingObject::live(), 0, "Elements built before the throw should be destroyed");
+    
+    allocator.reset();
+    TEST_EQUAL(ThrowingObject::live(), 0, "A failed array should not register destructors");
+}
+
+// Test that only the latest allocation grows in place
+DEFINE_TEST_G(ExtendInPlace, BumpAllocator) {
+    BumpAllocator<64> allocator;
+    
+    char* first = allocator.alloc<char>(8);
+    TEST_MESSAGE(allocator.extend(first, 8, 16), "The latest allocation should extend");
+    TEST_EQUAL(allocator.used(), 16, "Extending should bump the pointer");
+    TEST_EQUAL(allocator.allocations(), 1, "Extending should not count as an allocation");
+    
+    char* second = allocator.alloc<char>(8);
+    TEST_MESSAGE(!allocator.extend(first, 16, 24), "An older allocation should not extend");
+    TEST_MESSAGE(!allocator.extend(second, 8, 64), "An extension past the end should fail");
+    TEST_EQUAL(allocator.used(), 24, "Failed extensions should change nothing");
+    
+    BumpAllocator<64, InlineStorage, ArenaInstrumentation<>> instrumented;
+    char* block = instrumented.alloc<char>(8);
+    TEST_MESSAGE(!instrumented.extend(block, 8, 16), "Instrumented arenas should never extend");
+}
+
+// Test high-water, request, padding and failure counters
+DEFINE_TEST_G(Counters, ArenaInstrumentation) {
+    BumpAllocator<128, InlineStorage, ArenaInstrumentation<>> allocator;
+    
+    allocator.alloc<char>(3);
+    allocator.alloc<int>(4);
+    auto marker = allocator.mark();
+    allocator.alloc<char>(64);
+    allocator.rewind(marker);
+    allocator.alloc<char>(200);
+    allocator.alloc_aligned(8, 3);
+    
+    const auto& stats = allocator.instrumentation();
+    TEST_EQUAL(stats.high_water(), 84, "High water should include the rewound allocation");
+    TEST_EQUAL(stats.bytes_requested(), 83, "Only successful requests should count as bytes");
+    TEST_EQUAL(stats.total_padding(), 1, "int alignment should cost one byte of padding");
+    TEST_EQUAL(stats.failures(), 2, "Oversized and bad-alignment requests should both fail");
+    
+    allocator.reset();
+    TEST_EQUAL(stats.high_water(), 84, "Reset should not clear the high-water mark");
+    TEST_EQUAL(allocator.padding_waste(), 0, "Reset should still clear padding_waste()");
+    TEST_EQUAL(stats.total_padding(), 1, "Lifetime padding should survive reset");
+}
+
+// Test that requests are attributed to the line that made them
+DEFINE_TEST_G(CallSites, ArenaInstrumentation) {
+    BasicBumpArena<ArenaInstrumentation<>> arena(256);
+    
+    CallSite first{__FILE__, 0};
+    CallSite second{__FILE__, 0};
+    for (int i = 0; i < 3; ++i) {
+        first = CallSite::current(); arena.alloc<int>(2);
     }
+    second = CallSite::current(); arena.alloc<char>(1000);
+    
+    auto first_stats = arena.instrumentation().site_stats(first);
+    TEST_EQUAL(first_stats.allocations, 3, "Loop site should record 3 allocations");
+    TEST_EQUAL(first_stats.bytes, 24, "Loop site should record 24 bytes");
+    TEST_EQUAL(first_stats.failures, 0, "Loop site should have no failures");
+    
+    auto second_stats = arena.instrumentation().site_stats(second);
+    TEST_EQUAL(second_stats.allocations, 0, "Oversized site should record no allocations");
+    TEST_EQUAL(second_stats.failures, 1, "Oversized site should record its failure");
+    
+    std::ostringstream out;
+    arena.instrumentation().dump(out);
+    std::string text = out.str();
+    TEST_MESSAGE(text.find("3 allocations, 24 bytes") != std::string::npos, "Dump should list the loop site");
+    TEST_MESSAGE(text.find("1 failures") != std::string::npos, "Dump should list the failing site");
+    
+    // Typed construction is filed under its caller, not under task1.hpp
+    BasicBumpArena<ArenaInstrumentation<>> typed(512);
+    CallSite create_site = CallSite::current(); typed.create<std::pair<int, int>>(1, 2);
+    CallSite empty_site = CallSite::current(); typed.create<std::string>();
+    CallSite array_site = CallSite::current(); typed.create_array<double>(4, 0.5);
+    CallSite named{__FILE__, 1};
+    typed.create<int>(7, named);
+    TEST_EQUAL(typed.instrumentation().site_stats(create_site).allocations, 1, "create() should record its caller");
+    TEST_EQUAL(typed.instrumentation().site_stats(empty_site).allocations, 1,
+               "create() without arguments should record its caller");
+    TEST_EQUAL(typed.instrumentation().site_stats(array_site).bytes, 32, "create_array() should record its caller");
+    TEST_EQUAL(typed.instrumentation().site_stats(named).allocations, 1, "A trailing CallSite should name the site");
+}
+
+// Test that the ring buffer keeps the most recent events in order
+DEFINE_TEST_G(EventRing, ArenaInstrumentation) {
+    using Stats = ArenaInstrumentation<8, 4>;
+    BumpAllocator<256, InlineStorage, Stats> allocator;
+    
+    for (size_t size = 1; size <= 5; ++size) {
+        allocator.alloc<char>(size);
+    }
+    allocator.dealloc();
+    
+    const Stats& stats = allocator.instrumentation();
+    TEST_EQUAL(stats.event_count(), 4, "Ring should hold its capacity of events");
+    TEST_EQUAL(stats.event(0).size, 3, "Oldest held event should be the third allocation");
+    TEST_EQUAL(stats.event(2).size, 5, "Newest allocation should be third from last");
+    TEST_EQUAL(stats.event(3).kind, Stats::DEALLOC, "Last event should be the dealloc");
+    TEST_EQUAL(stats.event(3).used, 15, "Dealloc should record the bytes still in use");
+}
+
+// Test that every allocation is followed by its redzone
+DEFINE_TEST_G(Redzones, ArenaDebug) {
+    BumpAllocator<64, InlineStorage, ArenaDebug<16>> allocator;
+    
+    char* first = allocator.alloc<char>(8);
+    char* second = allocator.alloc<char>(8);
+    TEST_EQUAL(second - first, 24, "Blocks should be separated by a 16-byte redzone");
+    TEST_EQUAL(allocator.remaining_space(), 16, "Redzones should count against capacity");
+    TEST_MESSAGE(allocator.alloc<char>(1) == nullptr, "A block whose redzone does not fit should fail");
+}
+
+#ifndef ARENA_ASAN
+static size_t debug_corruptions = 0;
+
+static void count_corruption(const CallSite&, const void*) {
+    ++debug_corruptions;
+}
+
+// Test fill patterns for fresh, guard and released memory
+DEFINE_TEST_G(Poisoning, ArenaDebug) {
+    using Debug = ArenaDebug<8>;
+    BasicBumpArena<Debug> arena(128);
+    
+    auto marker = arena.mark();
+    unsigned char* block = arena.alloc<unsigned char>(4);
+    TEST_EQUAL(block[0], Debug::FRESH, "New memory should be filled with the fresh pattern");
+    TEST_EQUAL(block[4], Debug::GUARD, "The redzone should hold the guard pattern");
     
-    return pass ? 0 : 1;
-} 
\ No newline at end of file
+    arena.rewind(marker);
+    TEST_EQUAL(block[0], Debug::FREED, "Rewound memory should be poisoned");
+    TEST_EQUAL(block[11], Debug::FREED, "Rewound redzones should be poisoned");
+}
+
+// Test that an overrun is caught by verify() and on release
+DEFINE_TEST_G(OverrunDetection, ArenaDebug) {
+    BumpAllocator<256, InlineStorage, ArenaDebug<16>> allocator;
+    allocator.instrumentation().set_corruption_handler(count_corruption);
+    debug_corruptions = 0;
+    
+    char* intact = allocator.alloc<char>(8);
+    auto marker = allocator.mark();
+    char* overrun = allocator.alloc<char>(8);
+    std::memset(intact, 'x', 8);
+    TEST_MESSAGE(allocator.instrumentation().verify(), "In-bounds writes should leave guards intact");
+    
+    std::memset(overrun, 'x', 9);
+    TEST_MESSAGE(!allocator.instrumentation().verify(), "A one-byte overrun should be detected");
+    TEST_EQUAL(debug_corruptions, 1, "The handler should be called for the damaged guard");
+    
+    allocator.rewind(marker);
+    TEST_EQUAL(debug_corruptions, 2, "Releasing the damaged block should report it again");
+    TEST_MESSAGE(allocator.instrumentation().verify(), "Remaining guards should be intact");
+    TEST_EQUAL(allocator.instrumentation().corruptions(), 2, "Both reports should be counted");
+}
+#endif
+
+// Test an arena sized at runtime
+DEFINE_TEST_G(RuntimeCapacity, BumpArena) {
+    size_t configured = 100;
+    BumpArena arena(configured);
+    
+    TEST_EQUAL(arena.capacity(), configured, "Capacity should match the runtime size");
+    
+    int* x = arena.alloc<int>();
+    double* d = arena.alloc<double>();
+    TEST_MESSAGE(x != nullptr && d != nullptr, "Allocations should succeed");
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(d) % alignof(double), 0, "Double should be aligned");
+    TEST_EQUAL(arena.remaining_space(), configured - sizeof(int) - sizeof(double) - arena.padding_waste(),
+               "Remaining space should track allocations and padding");
+    TEST_MESSAGE(arena.alloc<char>(configured) == nullptr, "Should fail to allocate beyond capacity");
+}
+
+// Test an arena over a caller-provided buffer
+DEFINE_TEST_G(BorrowedBuffer, BumpArena) {
+    alignas(std::max_align_t) char buffer[64];
+    BumpArena arena(buffer, sizeof(buffer));
+    
+    char* c = arena.alloc<char>(64);
+    TEST_MESSAGE(c == buffer, "Allocation should come from the borrowed buffer");
+    TEST_EQUAL(arena.remaining_space(), 0, "Borrowed buffer should be exhausted");
+    
+    arena.reset();
+    TEST_EQUAL(arena.remaining_space(), sizeof(buffer), "Reset should reclaim the buffer");
+}
+
+static size_t fill_with_ints(BumpResource& resource) {
+    size_t count = 0;
+    while (resource.alloc<int>() != nullptr) {
+        ++count;
+    }
+    return count;
+}
+
+// Test that compile-time and runtime arenas share one interface
+DEFINE_TEST_G(SharedInterface, BumpArena) {
+    BumpAllocator<256> fixed;
+    BumpArena runtime(256);
+    
+    TEST_EQUAL(fill_with_ints(fixed), 256 / sizeof(int), "BumpAllocator should work as a BumpResource");
+    TEST_EQUAL(fill_with_ints(runtime), 256 / sizeof(int), "BumpArena should work as a BumpResource");
+    
+    BumpResource& resource = runtime;
+    resource.reset();
+    {
+        ArenaScope<BumpResource> scope(resource);
+        resource.alloc<char>(100);
+    }
+    TEST_EQUAL(resource.remaining_space(), 256, "ArenaScope should work through a BumpResource&");
+}
+
+// Test that the arena chains a new block instead of failing
+DEFINE_TEST_G(GrowBeyondBlock, ChainedBumpAllocator) {
+    ChainedBumpAllocator<> allocator(64, 1024);
+    
+    bool all_succeeded = true;
+    for (int i = 0; i < 100; ++i) {
+        int* x = allocator.alloc<int>();
+        if (x == nullptr) {
+            all_succeeded = false;
+            break;
+        }
+        *x = i;
+    }
+    
+    TEST_MESSAGE(all_succeeded, "Allocations past the first block should succeed");
+    TEST_EQUAL(allocator.allocations(), 100, "Should have 100 allocations");
+    TEST_MESSAGE(allocator.block_count() > 1, "Arena should have chained more blocks");
+}
+
+// Test that block sizes double and stop at the configured maximum
+DEFINE_TEST_G(GeometricGrowth, ChainedBumpAllocator) {
+    ChainedBumpAllocator<> allocator(64, 256);
+    
+    allocator.alloc<char>(64);
+    TEST_EQUAL(allocator.capacity(), 64, "First block should use the initial size");
+    
+    allocator.alloc<char>(64);
+    TEST_EQUAL(allocator.capacity(), 64 + 128, "Second block should double");
+    
+    allocator.alloc<char>(128);
+    allocator.alloc<char>(256);
+    TEST_EQUAL(allocator.capacity(), 64 + 128 + 256 + 256, "Growth should stop at the maximum");
+    TEST_EQUAL(allocator.block_count(), 4, "Should have chained 4 blocks");
+}
+
+// Test requests larger than the maximum block size
+DEFINE_TEST_G(OversizedRequest, ChainedBumpAllocator) {
+    ChainedBumpAllocator<> allocator(64, 256);
+    
+    void* big = allocator.alloc_aligned(4096, 64);
+    TEST_MESSAGE(big != nullptr, "Oversized request should get a dedicated block");
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(big) % 64, 0, "Oversized block should honor alignment");
+    
+    int* x = allocator.alloc<int>();
+    TEST_MESSAGE(x != nullptr, "Allocation after an oversized request should succeed");
+}
+
+// Test that reset keeps blocks and release returns them upstream
+DEFINE_TEST_G(ResetRecyclesBlocks, ChainedBumpAllocator) {
+    CountingUpstream::allocated = 0;
+    CountingUpstream::deallocated = 0;
+    {
+        ChainedBumpAllocator<CountingUpstream> allocator(64, 1024);
+        for (int i = 0; i < 3; ++i) {
+            allocator.alloc<char>(64);
+        }
+        size_t blocks = CountingUpstream::allocated;
+        
+        allocator.reset();
+        TEST_EQUAL(allocator.allocations(), 0, "Reset should drop all allocations");
+        TEST_EQUAL(allocator.block_count(), 0, "Reset should empty the active chain");
+        
+        for (int i = 0; i < 3; ++i) {
+            allocator.alloc<char>(64);
+        }
+        TEST_EQUAL(CountingUpstream::allocated, blocks, "Reset blocks should be reused");
+        TEST_EQUAL(CountingUpstream::deallocated, 0, "Reset should not free blocks");
+        
+        allocator.release();
+        TEST_EQUAL(CountingUpstream::deallocated, blocks, "Release should free every block");
+    }
+    TEST_EQUAL(CountingUpstream::deallocated, CountingUpstream::allocated,
+               "Destructor should not double free released blocks");
+}
+
+// Test that rewind recycles blocks chained after the mark
+DEFINE_TEST_G(MarkRewind, ChainedBumpAllocator) {
+    CountingUpstream::allocated = 0;
+    ChainedBumpAllocator<CountingUpstream> allocator(64, 64);
+    
+    int* live = allocator.alloc<int>();
+    *live = 7;
+    auto marker = allocator.mark();
+    
+    for (int i = 0; i < 4; ++i) {
+        allocator.alloc<char>(64);
+    }
+    TEST_EQUAL(allocator.block_count(), 5, "Phase should have chained 4 more blocks");
+    
+    allocator.rewind(marker);
+    TEST_EQUAL(allocator.block_count(), 1, "Rewind should return to the marked block");
+    TEST_EQUAL(allocator.allocations(), 1, "Rewind should drop allocations made after the mark");
+    TEST_EQUAL(*live, 7, "Allocations before the mark should be untouched");
+    
+    size_t blocks = CountingUpstream::allocated;
+    for (int i = 0; i < 4; ++i) {
+        allocator.alloc<char>(64);
+    }
+    TEST_EQUAL(CountingUpstream::allocated, blocks, "Next phase should reuse the recycled blocks");
+}
+
+// Test that rewind undoes the block growth of the released phase
+DEFINE_TEST_G(RewindRestoresGrowth, ChainedBumpAllocator) {
+    ChainedBumpAllocator<> allocator(64, 1024);
+    auto marker = allocator.mark();
+    
+    allocator.alloc<char>(64);
+    allocator.alloc<char>(128);
+    allocator.alloc<char>(256);
+    TEST_EQUAL(allocator.capacity(), 64 + 128 + 256, "Phase should have grown three blocks");
+    
+    // No recycled block fits, so the new one is sized from the restored growth
+    allocator.rewind(marker);
+    allocator.alloc<char>(300);
+    TEST_EQUAL(allocator.capacity(), 300, "The next block should not inherit the released phase's growth");
+}
+
+// Test that both ends share one buffer and fail only when they meet
+DEFINE_TEST_G(SharedBuffer, DoubleEndedArena) {
+    DoubleEndedArena<64> arena;
+    
+    char* low = arena.bottom().alloc<char>(24);
+    char* high = arena.top().alloc<char>(24);
+    TEST_MESSAGE(low != nullptr && high != nullptr, "Both ends should allocate");
+    TEST_EQUAL(high - low, 40, "Top block should end at the end of the buffer");
+    TEST_EQUAL(arena.remaining_space(), 16, "The gap should be what neither end took");
+    
+    TEST_MESSAGE(arena.top().alloc<char>(17) == nullptr, "Top should fail where it would cross the bottom");
+    TEST_MESSAGE(arena.bottom().alloc<char>(17) == nullptr, "Bottom should fail where it would cross the top");
+    TEST_MESSAGE(arena.bottom().alloc<char>(16) != nullptr, "The last gap bytes should still be usable");
+    TEST_EQUAL(arena.remaining_space(), 0, "The ends should now meet");
+    TEST_EQUAL(arena.allocations(), 3, "Allocations should be counted across both ends");
+}
+
+// Test that each end resets, deallocates and rewinds on its own
+DEFINE_TEST_G(IndependentResets, DoubleEndedArena) {
+    DoubleEndedArena<256> arena;
+    
+    int* kept = arena.bottom().alloc<int>();
+    *kept = 7;
+    for (int frame = 0; frame < 10; ++frame) {
+        arena.top().alloc<char>(100);
+        arena.top().reset();
+    }
+    TEST_EQUAL(arena.top().used(), 0, "Top reset should release the temporaries");
+    TEST_EQUAL(arena.bottom().used(), sizeof(int), "Top reset should leave the bottom alone");
+    TEST_EQUAL(*kept, 7, "Long-lived data should survive top resets");
+    
+    {
+        ArenaScope<DoubleEndedArena<256>::Top> scope(arena.top());
+        arena.top().alloc<double>(4);
+        TEST_EQUAL(arena.top().used(), 4 * sizeof(double), "Scoped temporaries should come from the top");
+    }
+    TEST_EQUAL(arena.top().used(), 0, "ArenaScope should rewind the top end");
+    
+    arena.top().alloc<char>();
+    arena.bottom().dealloc();
+    TEST_EQUAL(arena.bottom().used(), 0, "Freeing the last bottom block should reset the bottom");
+    TEST_EQUAL(arena.top().allocations(), 1, "Bottom dealloc should not touch the top");
+    
+    arena.reset();
+    TEST_EQUAL(arena.remaining_space(), 256, "Full reset should clear both ends");
+}
+
+// Test alignment on the downward-growing end
+DEFINE_TEST_G(TopAlignment, DoubleEndedArena) {
+    DoubleEndedArena<256> arena;
+    
+    arena.top().alloc<char>(3);
+    void* aligned = arena.top().alloc_aligned(10, 64);
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(aligned) % 64, 0, "Top allocation should honour the alignment");
+    TEST_EQUAL(arena.top().padding_waste(), arena.top().used() - 13, "Rounding down should count as padding");
+    TEST_MESSAGE(arena.top().alloc_aligned(8, 3) == nullptr, "Non-power-of-two alignment should fail");
+}
+
+// Test chunk hand-out and return on the shared pool
+DEFINE_TEST_G(AcquireRelease, ChunkPool) {
+    ChunkPool pool(256, 2);
+    
+    void* a = pool.acquire();
+    void* b = pool.acquire();
+    TEST_MESSAGE(a != nullptr && b != nullptr && a != b, "Pool should hand out distinct chunks");
+    TEST_MESSAGE(pool.acquire() == nullptr, "Exhausted pool should return nullptr");
+    
+    pool.release(a);
+    TEST_EQUAL(pool.available(), 1, "Released chunk should be available again");
+    TEST_MESSAGE(pool.acquire() == a, "Pool should hand the released chunk back out");
+}
+
+// Test that each thread bumps in its own chunks and returns them on exit
+DEFINE_TEST_G(PerThreadRefill, ThreadLocalArena) {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 1000;
+    ChunkPool pool(1024, 64);
+    
+    std::vector<std::vector<int*>> results(THREADS);
+    std::vector<char> intact(THREADS, 0);
+    std::atomic<int> done(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < THREADS; ++t) {
+        workers.emplace_back([&, t]() {
+            ThreadLocalArena& arena = ThreadLocalArena::local(pool);
+            for (int i = 0; i < PER_THREAD; ++i) {
+                int* x = arena.alloc<int>();
+                if (x != nullptr) {
+                    *x = t;
+                    results[t].push_back(x);
+                }
+            }
+            
+            // Keep every arena alive until all threads have allocated
+            done.fetch_add(1);
+            while (done.load() < THREADS) {
+                std::this_thread::yield();
+            }
+            intact[t] = std::all_of(results[t].begin(), results[t].end(),
+                                    [t](int* x) { return *x == t; });
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    std::vector<int*> all;
+    for (const auto& thread_results : results) {
+        all.insert(all.end(), thread_results.begin(), thread_results.end());
+    }
+    std::sort(all.begin(), all.end());
+    bool values_intact = std::all_of(intact.begin(), intact.end(), [](char ok) { return ok != 0; });
+    
+    TEST_EQUAL(all.size(), static_cast<size_t>(THREADS * PER_THREAD), "Every allocation should succeed");
+    TEST_MESSAGE(std::adjacent_find(all.begin(), all.end()) == all.end(),
+                 "Threads should never receive the same address");
+    TEST_MESSAGE(values_intact, "Threads should not overwrite each other's allocations");
+    TEST_EQUAL(pool.available(), pool.chunk_count(), "Exiting threads should return their chunks");
+}
+
+// Test that a thread's arena refuses a pool other than the one it bound to
+DEFINE_TEST_G(RejectsSecondPool, ThreadLocalArena) {
+    ChunkPool first(1024, 4);
+    ChunkPool second(1024, 4);
+    bool same_pool_ok = false;
+    bool second_pool_thrown = false;
+    std::thread worker([&]() {
+        same_pool_ok = &ThreadLocalArena::local(first) == &ThreadLocalArena::local(first);
+        try {
+            ThreadLocalArena::local(second);
+        } catch (const std::logic_error&) {
+            second_pool_thrown = true;
+        }
+    });
+    worker.join();
+    
+    TEST_MESSAGE(same_pool_ok, "Repeated calls with the same pool should return the same arena");
+    TEST_MESSAGE(second_pool_thrown, "A call with a second pool should throw std::logic_error");
+}
+
+// Test that threads sharing one arena receive disjoint allocations
+DEFINE_TEST_G(SharedAllocation, AtomicBumpAllocator) {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 1000;
+    static AtomicBumpAllocator<THREADS * PER_THREAD * 2 * sizeof(double)> allocator;
+    
+    std::vector<std::vector<double*>> results(THREADS);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < THREADS; ++t) {
+        workers.emplace_back([&results, t]() {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                double* d = allocator.alloc<double>();
+                if (d != nullptr) {
+                    *d = t;
+                    results[t].push_back(d);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    std::vector<double*> all;
+    bool aligned = true;
+    for (const auto& thread_results : results) {
+        for (double* d : thread_results) {
+            aligned &= reinterpret_cast<uintptr_t>(d) % alignof(double) == 0;
+            all.push_back(d);
+        }
+    }
+    std::sort(all.begin(), all.end());
+    
+    TEST_EQUAL(allocator.allocations(), static_cast<size_t>(THREADS * PER_THREAD),
+               "Every allocation should be counted");
+    TEST_MESSAGE(aligned, "Shared allocations should honor alignof(double)");
+    TEST_MESSAGE(std::adjacent_find(all.begin(), all.end(),
+                                    [](double* a, double* b) { return b - a < 1; }) == all.end(),
+                 "Shared allocations should never overlap");
+    
+    allocator.reset();
+    TEST_EQUAL(allocator.remaining_space(), allocator.capacity(), "Reset should reclaim all space");
+}
+
+// Test that a pmr container draws its storage from the arena
+DEFINE_TEST_G(PmrVector, BumpMemoryResource) {
+    BumpAllocator<4096> allocator;
+    BumpMemoryResource<BumpAllocator<4096>> resource(allocator);
+    
+    {
+        std::pmr::vector<int> values(&resource);
+        for (int i = 0; i < 100; ++i) {
+            values.push_back(i);
+        }
+        
+        TEST_EQUAL(values[99], 99, "Vector contents should survive reallocation");
+        TEST_MESSAGE(allocator.remaining_space() < allocator.capacity(),
+                     "Vector storage should come from the arena");
+        TEST_EQUAL(allocator.allocations(), 1, "Only the live buffer should be counted");
+    }
+    
+    TEST_EQUAL(allocator.remaining_space(), allocator.capacity(),
+               "Arena should reset once the container releases its storage");
+}
+
+// Test that arena exhaustion surfaces as std::bad_alloc
+DEFINE_TEST_G(Exhaustion, BumpMemoryResource) {
+    BumpAllocator<64> allocator;
+    BumpMemoryResource<BumpAllocator<64>> resource(allocator);
+    
+    bool threw = false;
+    try {
+        void* ptr = resource.allocate(128, alignof(std::max_align_t));
+        (void)ptr;
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    TEST_MESSAGE(threw, "Allocation beyond capacity should throw std::bad_alloc");
+    TEST_MESSAGE(resource.is_equal(resource), "Resource should compare equal to itself");
+}
+
+// Test the STL Allocator adapter with node-based and contiguous containers
+DEFINE_TEST_G(StdContainers, BumpStlAllocator) {
+    using Arena = ChainedBumpAllocator<>;
+    Arena arena(1024, 64 * 1024);
+    
+    BumpStlAllocator<int, Arena> int_alloc(arena);
+    std::vector<int, BumpStlAllocator<int, Arena>> values(int_alloc);
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    TEST_EQUAL(values[999], 999, "Vector should work on an arena allocator");
+    
+    using Pair = std::pair<const int, int>;
+    BumpStlAllocator<Pair, Arena> pair_alloc(arena);
+    std::map<int, int, std::less<int>, BumpStlAllocator<Pair, Arena>> squares(pair_alloc);
+    for (int i = 0; i < 100; ++i) {
+        squares[i] = i * i;
+    }
+    TEST_EQUAL(squares[12], 144, "Map should work through a rebound allocator");
+    TEST_MESSAGE(pair_alloc == int_alloc,
+                 "Adapters over the same arena should compare equal");
+}
+
+struct Session {
+    uint64_t id;
+    double last_seen;
+    char peer[48];
+};
+
+// Test that freed blocks are reused individually
+DEFINE_TEST_G(AllocFree, PoolAllocator) {
+    PoolAllocator<Session, 8> pool;
+    
+    Session* a = pool.alloc();
+    Session* b = pool.alloc();
+    TEST_MESSAGE(a != nullptr && b != nullptr && a != b, "Pool should hand out distinct blocks");
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(a) % alignof(Session), 0, "Blocks should honor alignof(T)");
+    TEST_EQUAL(pool.allocations(), 2, "Should have 2 live blocks");
+    
+    a->id = 1;
+    b->id = 2;
+    pool.dealloc(a);
+    TEST_EQUAL(pool.allocations(), 1, "Free should release a single block");
+    TEST_EQUAL(b->id, 2, "Other blocks should be untouched by a free");
+    
+    Session* c = pool.alloc();
+    TEST_MESSAGE(c == a, "Next allocation should reuse the freed block");
+}
+
+// Test that the pool obtains a new chunk once every block is live
+DEFINE_TEST_G(ChunkGrowth, PoolAllocator) {
+    PoolAllocator<int, 4> pool;
+    
+    for (int i = 0; i < 4; ++i) {
+        pool.alloc();
+    }
+    TEST_EQUAL(pool.chunk_count(), 1, "First chunk should hold 4 blocks");
+    TEST_EQUAL(pool.remaining_space(), 0, "First chunk should be exhausted");
+    
+    int* x = pool.alloc();
+    TEST_MESSAGE(x != nullptr, "Pool should grow instead of failing");
+    TEST_EQUAL(pool.chunk_count(), 2, "Pool should have obtained a second chunk");
+    TEST_EQUAL(pool.remaining_space(), 3 * pool.block_size(), "Second chunk should have 3 free blocks");
+}
+
+// Test chunks carved from a bump allocator
+DEFINE_TEST_G(ArenaBacked, PoolAllocator) {
+    BumpAllocator<4096> arena;
+    PoolAllocator<Session, 4> pool(arena);
+    
+    Session* s = pool.alloc();
+    TEST_MESSAGE(s != nullptr, "Arena-backed allocation should succeed");
+    TEST_MESSAGE(reinterpret_cast<char*>(s) >= reinterpret_cast<char*>(&arena) &&
+                 reinterpret_cast<char*>(s) < reinterpret_cast<char*>(&arena) + sizeof(arena),
+                 "Block should live inside the arena");
+    TEST_EQUAL(arena.allocations(), 1, "Arena should have served one chunk");
+    
+    bool exhausted = false;
+    for (int i = 0; i < 1000 && !exhausted; ++i) {
+        exhausted = pool.alloc() == nullptr;
+    }
+    TEST_MESSAGE(exhausted, "Pool should return nullptr once the arena is exhausted");
+}
+
+// Test that requests round up to a class and freed blocks are reused per class
+DEFINE_TEST_G(ClassRounding, SizeClassAllocator) {
+    SizeClassAllocator<> allocator;
+    
+    void* a = allocator.alloc_aligned(5, 1);
+    void* b = allocator.alloc_aligned(100, 1);
+    TEST_MESSAGE(a != nullptr && b != nullptr, "Small allocations should succeed");
+    
+    allocator.dealloc(a, 5);
+    void* c = allocator.alloc_aligned(7, 1);
+    TEST_MESSAGE(c == a, "Same-class allocation should reuse the freed block");
+    
+    void* d = allocator.alloc_aligned(60, 1);
+    TEST_MESSAGE(d != b, "Different-class allocation should not reuse another class");
+    
+    TEST_MESSAGE(allocator.alloc_aligned(allocator.max_size() + 1, 1) == nullptr,
+                 "Requests above the largest class should fail");
+    TEST_EQUAL(allocator.allocations(), 3, "Should have 3 live allocations");
+}
+
+// Test that blocks honor alignment within their class
+DEFINE_TEST_G(Alignment, SizeClassAllocator) {
+    SizeClassAllocator<> allocator;
+    
+    allocator.alloc<char>();
+    double* d = allocator.alloc<double>();
+    void* line = allocator.alloc_aligned(48, 64);
+    
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(d) % alignof(double), 0, "Double should be aligned");
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(line) % 64, 0, "Pointer should be 64-byte aligned");
+}
+
+// Test per-class occupancy reporting
+DEFINE_TEST_G(Occupancy, SizeClassAllocator) {
+    SizeClassAllocator<256, 4096> allocator;
+    
+    void* blocks[10];
+    for (int i = 0; i < 10; ++i) {
+        blocks[i] = allocator.alloc<int>(4);
+    }
+    allocator.dealloc(blocks[0], 16);
+    allocator.dealloc(blocks[1], 16);
+    allocator.alloc<char>(200);
+    
+    auto sixteen = allocator.class_stats(1);
+    TEST_EQUAL(sixteen.block_size, 16, "Second class should hold 16-byte blocks");
+    TEST_EQUAL(sixteen.live, 8, "16-byte class should have 8 live blocks");
+    TEST_EQUAL(sixteen.free, 2, "16-byte class should have 2 free blocks");
+    TEST_EQUAL(sixteen.chunks, 1, "16-byte class should have carved one chunk");
+    
+    auto largest = allocator.class_stats(allocator.class_count() - 1);
+    TEST_EQUAL(largest.block_size, 256, "Largest class should hold 256-byte blocks");
+    TEST_EQUAL(largest.live, 1, "Largest class should have 1 live block");
+    
+    allocator.reset();
+    TEST_EQUAL(allocator.allocations(), 0, "Reset should drop every allocation");
+    TEST_EQUAL(allocator.class_stats(1).chunks, 0, "Reset should clear class chunks");
+}
+
+// Test that a trace survives the binary format unchanged
+DEFINE_TEST_G(SaveLoad, AllocTrace) {
+    AllocTrace trace;
+    trace.push(24, 8, 2, 0);
+    trace.push(4096, 64, 0, 3);
+    trace.push(1, 1, 1, 1);
+    
+    std::stringstream file;
+    TEST_MESSAGE(trace.save(file), "Save should succeed");
+    TEST_EQUAL(file.str().size(), 20 + 3 * 12, "File should be a 20-byte header plus 12 bytes per event");
+    
+    AllocTrace loaded;
+    TEST_MESSAGE(loaded.load(file), "Load should succeed");
+    TEST_EQUAL(loaded.size(), 3, "All events should be loaded");
+    TEST_EQUAL(loaded.thread_count(), 4, "Thread count should be preserved");
+    
+    const TraceEvent& event = loaded.events()[1];
+    TEST_EQUAL(event.size, 4096, "Size should be preserved");
+    TEST_EQUAL(event.align(), 64, "Alignment should be preserved");
+    TEST_EQUAL(event.lifetime, 0, "Lifetime should be preserved");
+    TEST_EQUAL(event.thread, 3, "Thread should be preserved");
+}
+
+// Test that corrupt or truncated files are rejected
+DEFINE_TEST_G(RejectsBadFile, AllocTrace) {
+    AllocTrace trace;
+    std::stringstream garbage("not a trace file at all");
+    TEST_MESSAGE(!trace.load(garbage), "Bad magic should be rejected");
+    
+    AllocTrace source;
+    source.push(16, 16, 1);
+    source.push(32, 16, 0);
+    std::stringstream file;
+    source.save(file);
+    std::string bytes = file.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 4));
+    TEST_MESSAGE(!trace.load(truncated), "Truncated file should be rejected");
+    TEST_EQUAL(trace.size(), 0, "A failed load should leave the trace empty");
+    
+    // Header fields: magic, version, thread count, event count
+    auto header = [](uint32_t threads, uint64_t count) {
+        std::string bytes = "ATRC";
+        for (uint64_t value : {uint64_t(1), uint64_t(threads)}) {
+            for (int i = 0; i < 4; ++i) bytes += static_cast<char>((value >> (8 * i)) & 0xff);
+        }
+        for (int i = 0; i < 8; ++i) bytes += static_cast<char>((count >> (8 * i)) & 0xff);
+        return bytes;
+    };
+    std::stringstream too_many(header(0xffffffffu, 0));
+    TEST_MESSAGE(!trace.load(too_many), "A header claiming more than MAX_THREADS threads should be rejected");
+    std::stringstream no_threads(header(0, 0));
+    TEST_MESSAGE(!trace.load(no_threads), "A header claiming no threads should be rejected");
+    
+    std::string stray = bytes;
+    stray[20 + 12 + 9] = 1;         // The header claims one thread; move the second event to thread 1
+    std::stringstream mismatched(stray);
+    TEST_MESSAGE(!trace.load(mismatched), "An event on a thread outside the header count should be rejected");
+    
+    std::stringstream valid(bytes);
+    TEST_MESSAGE(trace.load(valid) && trace.thread_count() == 1, "The saved trace should still load");
+}
+
+// Test that synthetic traces are reproducible and follow the config
+DEFINE_TEST_G(Synthesize, AllocTrace) {
+    SyntheticTraceConfig config;
+    config.allocations = 5000;
+    config.threads = 3;
+    config.min_size = 16;
+    config.max_size = 512;
+    config.phase_length = 100;
+    
+    AllocTrace first = AllocTrace::synthesize(config);
+    AllocTrace second = AllocTrace::synthesize(config);
+    TEST_EQUAL(first.size(), 5000, "Trace should have the configured length");
+    TEST_EQUAL(first.thread_count(), 3, "Trace should have the configured threads");
+    
+    bool same = true;
+    bool in_range = true;
+    size_t smallest = 0;
+    size_t largest_half = 0;
+    for (size_t i = 0; i < first.size(); ++i) {
+        const TraceEvent& a = first.events()[i];
+        const TraceEvent& b = second.events()[i];
+        same &= a.size == b.size && a.lifetime == b.lifetime && a.thread == b.thread;
+        in_range &= a.size >= 16 && a.size <= 512 && a.thread < 3;
+        in_range &= a.lifetime == 0 || i + a.lifetime < first.size();
+        smallest += a.size == 16;
+        largest_half += a.size > 264;
+    }
+    TEST_MESSAGE(same, "Same seed should give the same trace");
+    TEST_MESSAGE(in_range, "Sizes, threads and lifetimes should stay in range");
+    TEST_MESSAGE(smallest > largest_half, "Zipf weights should favour the smallest size");
+}
+
+// Test that replay frees every allocation exactly once, in lifetime order
+DEFINE_TEST_G(ReplaySchedule, TraceReplay) {
+    AllocTrace trace;
+    trace.push(8, 8, 1, 0);    // Freed after event 1
+    trace.push(16, 8, 0, 1);   // Lives to the end
+    trace.push(32, 8, 1, 0);   // Would outlive the trace; freed at the end
+    
+    TraceReplay replay(trace);
+    TEST_EQUAL(replay.allocations(), 3, "All events should be scheduled");
+    TEST_EQUAL(replay.peak_bytes(), 48, "Event 0 should be freed before event 2 is allocated");
+    
+    BumpAllocator<256> arena;
+    std::vector<size_t> freed;
+    size_t failures = replay.run([&](size_t size, size_t align) { return arena.alloc_aligned(size, align); },
+                                 [&](void*, size_t size, size_t) { freed.push_back(size); arena.dealloc(); });
+    TEST_EQUAL(failures, 0, "No allocation should fail");
+    TEST_EQUAL(freed.size(), 3, "Every allocation should be freed");
+    TEST_EQUAL(freed[0], 8, "The short-lived block should be freed first");
+    TEST_EQUAL(arena.allocations(), 0, "All frees should reach the allocator");
+    
+    TraceReplay thread_one(trace, 1);
+    TEST_EQUAL(thread_one.allocations(), 1, "A thread filter should keep only that thread's events");
+}
+
+#ifdef ARENA_STORAGE_HAS_MMAP
+// Test that stacks are page-aligned, writable and separate
+DEFINE_TEST_G(CarveStacks, FiberStackPool) {
+    FiberStackPool pool(10000, 4);
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    
+    FiberStack first = pool.acquire();
+    FiberStack second = pool.acquire();
+    TEST_MESSAGE(first && second, "Stacks should be handed out");
+    TEST_EQUAL(pool.stack_size() % page, 0, "Stack size should be rounded to whole pages");
+    TEST_MESSAGE(pool.stack_size() >= 10000, "Stack size should cover the request");
+    TEST_EQUAL(reinterpret_cast<uintptr_t>(first.base) % page, 0, "Stacks should be page-aligned");
+    TEST_EQUAL(static_cast<size_t>(second.base - first.base), pool.stack_size() + pool.guard_size(),
+               "Adjacent stacks should be separated by one guard page");
+    
+    std::memset(first.base, 1, first.size);
+    std::memset(second.base, 2, second.size);
+    TEST_EQUAL(first.top()[-1], 1, "Writing one stack should not touch its neighbour");
+    TEST_EQUAL(pool.in_use(), 2, "Two stacks should be in use");
+}
+
+// Test free-list recycling and exhaustion
+DEFINE_TEST_G(RecycleStacks, FiberStackPool) {
+    FiberStackPool pool(4096, 2);
+    
+    FiberStack first = pool.acquire();
+    FiberStack second = pool.acquire();
+    TEST_MESSAGE(!pool.acquire(), "A full pool should return an empty stack");
+    
+    pool.release(first);
+    FiberStack reused = pool.acquire();
+    TEST_MESSAGE(reused.base == first.base, "Released stacks should be reused first");
+    TEST_EQUAL(pool.carved(), 2, "Reuse should not carve a new slot");
+    
+    pool.release(reused);
+    pool.release(second);
+    TEST_EQUAL(pool.in_use(), 0, "All stacks should be back in the pool");
+}
+
+// Test that decommitted stacks come back zeroed
+DEFINE_TEST_G(DecommitOnRelease, FiberStackPool) {
+    FiberStackPool pool(64 * 1024, 1, true);
+    
+    FiberStack stack = pool.acquire();
+    std::memset(stack.base, 0x5a, stack.size);
+    pool.release(stack);
+    
+    stack = pool.acquire();
+    TEST_EQUAL(stack.base[0], 0, "Decommitted pages should read back as zero");
+    TEST_EQUAL(stack.base[stack.size / 2], 0, "The whole lower stack should be decommitted");
+}
+
+// Test that the page below a stack faults on overflow
+DEFINE_TEST_G(GuardPage, FiberStackPool) {
+    FiberStackPool pool(4096, 1);
+    FiberStack stack = pool.acquire();
+    
+    pid_t child = fork();
+    if (child == 0) {
+        // Die by the signal even where a sanitizer installed its own handler
+        std::signal(SIGSEGV, SIG_DFL);
+        volatile char* below = stack.base - 1;
+        *below = 1;
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    TEST_MESSAGE(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV,
+                 "Writing below the stack should hit the guard page");
+}
+
+// Pair of contexts for driving a raw fiber from a test
+struct ContextPair {
+    FiberContext caller;
+    FiberContext fiber;
+    int counter = 0;
+    
+    explicit ContextPair(FiberContext::Mode mode) : caller(mode), fiber(mode) {}
+};
+
+// Test switching back and forth, with the fiber keeping its own stack state
+DEFINE_TEST_G(PingPong, FiberContext) {
+    for (FiberContext::Mode mode : {FiberContext::Mode::LITE, FiberContext::Mode::FULL}) {
+        FiberStackPool pool(16 * 1024, 1);
+        FiberStack stack = pool.acquire();
+        ContextPair pair(mode);
+        bool made = pair.fiber.make(stack.base, stack.size, [](void* arg) {
+            ContextPair* pair = static_cast<ContextPair*>(arg);
+            for (int local = 1;; ++local) {
+                pair->counter = local * 10;
+                FiberContext::swap(pair->fiber, pair->caller);
+            }
+        }, &pair);
+        TEST_MESSAGE(made, "A context should be made on a pool stack");
+        
+        int sum = 0;
+        for (int i = 0; i < 5; ++i) {
+            FiberContext::swap(pair.caller, pair.fiber);
+            sum += pair.counter;
+        }
+        TEST_EQUAL(sum, 150, "Each resume should continue the fiber's loop where it stopped");
+    }
+}
+
+#if defined(__x86_64__)
+static uint32_t read_mxcsr() {
+    uint32_t mxcsr;
+    asm volatile("stmxcsr %0" : "=m"(mxcsr));
+    return mxcsr;
+}
+
+static void write_mxcsr(uint32_t mxcsr) {
+    asm volatile("ldmxcsr %0" : : "m"(mxcsr));
+}
+#endif
+
+// Test that the MXCSR is saved per context even in LITE mode
+DEFINE_TEST_G(ControlWords, FiberContext) {
+#if defined(__x86_64__)
+    FiberStackPool pool(16 * 1024, 1);
+    FiberStack stack = pool.acquire();
+    ContextPair pair(FiberContext::Mode::LITE);
+    pair.fiber.make(stack.base, stack.size, [](void* arg) {
+        ContextPair* pair = static_cast<ContextPair*>(arg);
+        // Round toward zero inside the fiber only
+        write_mxcsr(read_mxcsr() | 0x6000);
+        while (true) {
+            pair->counter = static_cast<int>(read_mxcsr() & 0x6000);
+            FiberContext::swap(pair->fiber, pair->caller);
+        }
+    }, &pair);
+    
+    uint32_t before = read_mxcsr();
+    FiberContext::swap(pair.caller, pair.fiber);
+    TEST_EQUAL(read_mxcsr(), before, "The caller's MXCSR should survive the fiber changing its own");
+    FiberContext::swap(pair.caller, pair.fiber);
+    TEST_EQUAL(pair.counter, 0x6000, "The fiber's MXCSR should be restored when it resumes");
+    write_mxcsr(before);
+#endif
+}
+
+// Test that FULL mode keeps a vector register live across a switch
+DEFINE_TEST_G(FullState, FiberContext) {
+#if defined(FIBER_CONTEXT_ASM)
+    FiberStackPool pool(16 * 1024, 1);
+    FiberStack stack = pool.acquire();
+    ContextPair pair(FiberContext::Mode::FULL);
+    pair.fiber.make(stack.base, stack.size, [](void* arg) {
+        ContextPair* pair = static_cast<ContextPair*>(arg);
+        while (true) {
+            asm volatile("pxor %%xmm15, %%xmm15" : : : "xmm15");
+            FiberContext::swap(pair->fiber, pair->caller);
+        }
+    }, &pair);
+    
+    uint64_t in = 0x0123456789abcdefull;
+    uint64_t out = 0;
+    asm volatile("movq %0, %%xmm15" : : "r"(in));
+    FiberContext::swap(pair.caller, pair.fiber);
+    asm volatile("movq %%xmm15, %0" : "=r"(out));
+    TEST_EQUAL(out, in, "xmm15 should survive a FULL switch to a fiber that clears it");
+#endif
+}
+
+// Test that every spawned fiber runs exactly once across the workers
+DEFINE_TEST_G(RunAll, FiberScheduler) {
+    std::vector<std::atomic<int>> runs(500);
+    {
+        FiberScheduler scheduler(4, 16 * 1024, 64);
+        TEST_EQUAL(scheduler.workers(), 4, "The requested workers should be started");
+        size_t spawned = 0;
+        for (size_t i = 0; i < runs.size(); ++i) {
+            while (!scheduler.spawn([&runs, i] { runs[i].fetch_add(1); })) {
+                std::this_thread::yield();
+            }
+            ++spawned;
+        }
+        TEST_EQUAL(spawned, runs.size(), "Spawning should succeed once stacks are recycled");
+        scheduler.wait();
+        TEST_EQUAL(scheduler.live(), 0, "No fiber should be alive after wait()");
+    }
+    size_t once = 0;
+    for (std::atomic<int>& count : runs) {
+        once += count.load() == 1;
+    }
+    TEST_EQUAL(once, runs.size(), "Every fiber should run exactly once");
+}
+
+// Test that yielding fibers interleave on a single worker
+DEFINE_TEST_G(Yield, FiberScheduler) {
+    FiberScheduler scheduler(1, 16 * 1024, 8);
+    std::vector<int> order;
+    // Spawn both from one fiber so neither can start before the other is queued
+    scheduler.spawn([&] {
+        for (int id = 0; id < 2; ++id) {
+            scheduler.spawn([&order, id] {
+                for (int step = 0; step < 3; ++step) {
+                    order.push_back(id);
+                    FiberScheduler::yield();
+                }
+            });
+        }
+    });
+    scheduler.wait();
+    
+    TEST_EQUAL(order.size(), 6, "Both fibers should run to completion");
+    size_t alternations = 0;
+    for (size_t i = 1; i < order.size(); ++i) {
+        alternations += order[i] != order[i - 1];
+    }
+    TEST_EQUAL(alternations, 5, "Yield should hand the worker to the other fiber");
+    TEST_EQUAL(FiberScheduler::worker_index(), SIZE_MAX, "The test thread should not be a worker");
+}
+
+// Test spawning from inside fibers, and that other workers steal the work
+DEFINE_TEST_G(NestedSpawn, FiberScheduler) {
+    std::atomic<size_t> leaves(0);
+    std::atomic<size_t> workers_seen[4] = {};
+    FiberScheduler scheduler(4, 16 * 1024, 256);
+    scheduler.spawn([&] {
+        for (int child = 0; child < 100; ++child) {
+            while (!scheduler.spawn([&] {
+                FiberScheduler::yield();
+                // Blocking the worker leaves the rest of its queues to thieves
+                if (leaves.load() < 10) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                workers_seen[FiberScheduler::worker_index()].fetch_add(1);
+                leaves.fetch_add(1);
+            })) {
+                FiberScheduler::yield();
+            }
+        }
+    });
+    scheduler.wait();
+    
+    TEST_EQUAL(leaves.load(), 100, "Every nested fiber should run");
+    size_t busy = 0;
+    for (std::atomic<size_t>& seen : workers_seen) {
+        busy += seen.load() > 0;
+    }
+    TEST_MESSAGE(scheduler.steals() > 0 && busy > 1, "Idle workers should steal nested fibers");
+}
+
+// Test that a worker's scratch arena is reset between fibers
+DEFINE_TEST_G(ScratchReset, FiberScheduler) {
+    FiberScheduler scheduler(1, 16 * 1024, 8, 4096);
+    std::vector<size_t> used_on_entry;
+    std::vector<bool> allocated;
+    for (int i = 0; i < 3; ++i) {
+        scheduler.spawn([&] {
+            BumpArena& scratch = FiberScheduler::scratch();
+            used_on_entry.push_back(scratch.used());
+            allocated.push_back(scratch.alloc<char>(3000) != nullptr);
+            FiberScheduler::yield();
+            used_on_entry.push_back(FiberScheduler::scratch().used());
+        });
+    }
+    scheduler.wait();
+    
+    TEST_EQUAL(used_on_entry.size(), 6, "Every fiber should run to completion");
+    size_t clean = static_cast<size_t>(std::count(used_on_entry.begin(), used_on_entry.end(), size_t(0)));
+    TEST_EQUAL(clean, 6, "Scratch should be empty whenever a fiber is resumed");
+    size_t fits = static_cast<size_t>(std::count(allocated.begin(), allocated.end(), true));
+    TEST_EQUAL(fits, 3, "Each fiber should get the whole scratch arena");
+}
+
+// Backends to exercise: epoll always, io_uring when the kernel has it
+static std::vector<FiberReactor::Backend> reactor_backends() {
+    std::vector<FiberReactor::Backend> backends{FiberReactor::Backend::EPOLL};
+    FiberScheduler scheduler(1, 16 * 1024, 1);
+    FiberReactor probe(scheduler);
+    if (probe.backend() == FiberReactor::Backend::IO_URING) {
+        backends.push_back(FiberReactor::Backend::IO_URING);
+    }
+    return backends;
+}
+
+// Test a fiber parked on an empty pipe being resumed by another fiber's write
+DEFINE_TEST_G(PipeReadWrite, FiberReactor) {
+    for (FiberReactor::Backend backend : reactor_backends()) {
+        FiberScheduler scheduler(2, 64 * 1024, 8);
+        FiberReactor reactor(scheduler, 4096, 4, backend);
+        int pipe_fds[2];
+        TEST_EQUAL(pipe2(pipe_fds, O_NONBLOCK | O_CLOEXEC), 0, "A non-blocking pipe should be created");
+        
+        char received[16] = {};
+        std::atomic<ssize_t> read_result(0);
+        std::atomic<ssize_t> write_result(0);
+        scheduler.spawn([&] {
+            read_result.store(reactor.read(pipe_fds[0], received, sizeof(received)));
+        });
+        scheduler.spawn([&] {
+            // Let the reader park first
+            for (int i = 0; i < 10; ++i) {
+                FiberScheduler::yield();
+            }
+            write_result.store(reactor.write(pipe_fds[1], "hello", 5));
+        });
+        scheduler.wait();
+        
+        TEST_EQUAL(write_result.load(), 5, "The write should complete");
+        TEST_EQUAL(read_result.load(), 5, "The parked read should return the written bytes");
+        TEST_MESSAGE(std::memcmp(received, "hello", 5) == 0, "The read should see the data");
+        TEST_MESSAGE(reactor.submitted() > 0, "The read should have gone through the reactor");
+        TEST_EQUAL(reactor.in_flight(), 0, "Nothing should be left in flight");
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+    }
+}
+
+// Test accepting a connection and reading into a pooled buffer
+DEFINE_TEST_G(AcceptConnection, FiberReactor) {
+    for (FiberReactor::Backend backend : reactor_backends()) {
+        FiberScheduler scheduler(2, 64 * 1024, 8);
+        FiberReactor reactor(scheduler, 4096, 4, backend);
+        if (backend == FiberReactor::Backend::IO_URING) {
+            TEST_MESSAGE(reactor.fixed_buffers(), "The buffer pool should be registered with the ring");
+        }
+        
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::snprintf(address.sun_path, sizeof(address.sun_path), "/tmp/fiber_reactor_%d", getpid());
+        unlink(address.sun_path);
+        int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        TEST_EQUAL(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0,
+                   "The listener should bind");
+        listen(listener, 4);
+        
+        std::string received;
+        scheduler.spawn([&] {
+            int connection = reactor.accept(listener);
+            if (connection < 0) {
+                return;
+            }
+            fcntl(connection, F_SETFL, fcntl(connection, F_GETFL) | O_NONBLOCK);
+            char* buffer = reactor.acquire_buffer();
+            ssize_t n = reactor.read(connection, buffer, reactor.buffer_size());
+            if (n > 0) {
+                received.assign(buffer, static_cast<size_t>(n));
+            }
+            reactor.release_buffer(buffer);
+            close(connection);
+        });
+        std::thread client([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+                ssize_t written = ::write(fd, "ping", 4);
+                (void)written;
+            }
+            close(fd);
+        });
+        scheduler.wait();
+        client.join();
+        
+        TEST_MESSAGE(received == "ping", "The accepted connection should deliver the client's data");
+        close(listener);
+        unlink(address.sun_path);
+    }
+}
+
+// Test that fibers parking in a burst are submitted together
+DEFINE_TEST_G(BatchedSubmission, FiberReactor) {
+    constexpr size_t READERS = 32;
+    for (FiberReactor::Backend backend : reactor_backends()) {
+        FiberScheduler scheduler(1, 16 * 1024, READERS + 1);
+        FiberReactor reactor(scheduler, 4096, 4, backend);
+        std::vector<std::array<int, 2>> pipes(READERS);
+        for (std::array<int, 2>& fds : pipes) {
+            pipe2(fds.data(), O_NONBLOCK | O_CLOEXEC);
+        }
+        
+        std::atomic<size_t> completed(0);
+        // Spawn from a fiber so every reader is queued before the first parks
+        scheduler.spawn([&] {
+            for (size_t i = 0; i < READERS; ++i) {
+                int fd = pipes[i][0];
+                scheduler.spawn([&reactor, &completed, fd] {
+                    char byte;
+                    if (reactor.read(fd, &byte, 1) == 1) {
+                        completed.fetch_add(1);
+                    }
+                });
+            }
+        });
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (reactor.in_flight() < READERS && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        TEST_EQUAL(reactor.in_flight(), READERS, "Every reader should be parked in the kernel");
+        TEST_MESSAGE(reactor.batches() < reactor.submitted(), "Parked reads should share submissions");
+        
+        for (std::array<int, 2>& fds : pipes) {
+            ssize_t written = ::write(fds[1], "x", 1);
+            (void)written;
+        }
+        scheduler.wait();
+        TEST_EQUAL(completed.load(), READERS, "Every reader should be resumed with its byte");
+        for (std::array<int, 2>& fds : pipes) {
+            close(fds[0]);
+            close(fds[1]);
+        }
+    }
+}
+
+// Test that calls from outside a fiber behave like the plain syscalls
+DEFINE_TEST_G(OutsideFiber, FiberReactor) {
+    FiberScheduler scheduler(1, 16 * 1024, 1);
+    FiberReactor reactor(scheduler);
+    int pipe_fds[2];
+    pipe2(pipe_fds, O_NONBLOCK | O_CLOEXEC);
+    
+    char byte = 0;
+    TEST_EQUAL(reactor.read(pipe_fds[0], &byte, 1), -1, "An empty non-blocking pipe should fail");
+    TEST_EQUAL(errno, EAGAIN, "The failure should be EAGAIN");
+    TEST_EQUAL(reactor.write(pipe_fds[1], "z", 1), 1, "A write should go straight through");
+    TEST_MESSAGE(reactor.wait(pipe_fds[0], POLLIN) & POLLIN, "wait() should poll the fd directly");
+    TEST_EQUAL(reactor.read(pipe_fds[0], &byte, 1), 1, "The read should return the byte");
+    TEST_EQUAL(reactor.submitted(), 0, "Nothing should be submitted to the reactor");
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+#endif
+
+// Test LIFO pops for the owner and FIFO steals for everyone else
+DEFINE_TEST_G(OwnerOrder, WorkStealingDeque) {
+    WorkStealingDeque<int, 4> deque;
+    int values[5] = {0, 1, 2, 3, 4};
+    
+    TEST_MESSAGE(deque.pop() == nullptr, "An empty deque should pop nothing");
+    for (int i = 0; i < 4; ++i) {
+        TEST_MESSAGE(deque.push(&values[i]), "Pushes should fit the capacity");
+    }
+    TEST_MESSAGE(!deque.push(&values[4]), "A full deque should refuse a push");
+    TEST_EQUAL(deque.size(), 4, "Size should count pushed items");
+    
+    TEST_MESSAGE(deque.pop() == &values[3], "The owner should pop the newest item");
+    TEST_MESSAGE(deque.steal() == &values[0], "A thief should take the oldest item");
+    TEST_MESSAGE(deque.push(&values[4]), "Popping and stealing should free slots");
+    TEST_MESSAGE(deque.steal() == &values[1], "Steals should continue in FIFO order");
+    TEST_MESSAGE(deque.pop() == &values[4], "Pops should continue in LIFO order");
+    TEST_MESSAGE(deque.pop() == &values[2], "The last item should go to the owner");
+    TEST_MESSAGE(deque.steal() == nullptr, "An empty deque should yield nothing to steal");
+}
+
+// Test that every item is taken exactly once under contention
+DEFINE_TEST_G(ConcurrentSteal, WorkStealingDeque) {
+    constexpr size_t ITEMS = 100000;
+    WorkStealingDeque<size_t, 256> deque;
+    std::vector<size_t> items(ITEMS);
+    std::vector<std::atomic<int>> taken(ITEMS);
+    std::atomic<bool> done(false);
+    
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load()) {
+                if (size_t* item = deque.steal()) {
+                    taken[*item].fetch_add(1);
+                }
+            }
+        });
+    }
+    for (size_t i = 0; i < ITEMS; ++i) {
+        items[i] = i;
+        while (!deque.push(&items[i])) {
+            if (size_t* item = deque.pop()) {
+                taken[*item].fetch_add(1);
+            }
+        }
+        if (i % 3 == 0) {
+            if (size_t* item = deque.pop()) {
+                taken[*item].fetch_add(1);
+            }
+        }
+    }
+    while (size_t* item = deque.pop()) {
+        taken[*item].fetch_add(1);
+    }
+    done.store(true);
+    for (std::thread& thief : thieves) {
+        thief.join();
+    }
+    
+    size_t once = 0;
+    for (std::atomic<int>& count : taken) {
+        once += count.load() == 1;
+    }
+    TEST_EQUAL(once, ITEMS, "Every item should be popped or stolen exactly once");
+}
+
+// Test that short strings stay inside the object
+DEFINE_TEST_G(InlineBuffer, MyString) {
+    TEST_EQUAL(sizeof(MyString), 3 * sizeof(void*), "The heap resource should add no size");
+    
+    MyString empty;
+    TEST_MESSAGE(empty.is_inline() && empty.empty() && *empty.c_str() == '\0',
+                 "A default string should be empty and inline");
+    
+    MyString full(std::string(MyString::inline_capacity(), 'x'));
+    TEST_MESSAGE(full.is_inline(), "A string of inline_capacity() characters should stay inline");
+    TEST_EQUAL(full.size(), MyString::inline_capacity(), "Size should be read from the last byte");
+    TEST_EQUAL(full.c_str()[full.size()], '\0', "The size byte should double as the terminator");
+    
+    full.push_back('y');
+    TEST_MESSAGE(!full.is_inline(), "One more character should move the string to the heap");
+    TEST_EQUAL(full.size(), MyString::inline_capacity() + 1, "Moving to the heap should keep the size");
+    TEST_EQUAL(full[full.size() - 1], 'y', "Moving to the heap should keep the characters");
+    
+    MyString moved(std::move(full));
+    TEST_MESSAGE(full.empty() && full.is_inline(), "A moved-from string should be empty and inline");
+    TEST_EQUAL(moved.size(), MyString::inline_capacity() + 1, "Moving should steal the heap buffer");
+}
+
+// Test editing, searching and case conversion
+DEFINE_TEST_G(AppendAndSearch, MyString) {
+    MyString header("Content-Type");
+    header += ": ";
+    header.append("Text/HTML; charset=UTF-8");
+    TEST_EQUAL(header.view(), std::string_view("Content-Type: Text/HTML; charset=UTF-8"),
+               "Appends should concatenate");
+    TEST_EQUAL(header.find(':'), 12, "find(char) should return the first match");
+    TEST_EQUAL(header.find("charset"), 25, "find() should locate a substring");
+    TEST_EQUAL(header.rfind('T'), 34, "rfind() should return the last match");
+    TEST_MESSAGE(!header.contains("gzip"), "contains() should reject a missing substring");
+    
+    header.to_lower();
+    TEST_MESSAGE(header == "content-type: text/html; charset=utf-8", "to_lower() should fold ASCII");
+    TEST_MESSAGE(header.compare("content-type") > 0 && header < "content-typf",
+                 "Comparisons should be lexicographic");
+    
+    MyString twice("abcdefghijklmnop");
+    twice.append(twice.view());
+    TEST_EQUAL(twice.view(), std::string_view("abcdefghijklmnopabcdefghijklmnop"),
+               "Appending a string to itself should survive leaving the inline buffer");
+    
+    MyString padded(3, '-');
+    padded.resize(5, '+');
+    TEST_EQUAL(padded.view(), std::string_view("---++"), "resize() should fill with the character");
+}
+
+// Test that a string at the end of the arena grows without moving
+DEFINE_TEST_G(ArenaGrowsInPlace, MyString) {
+    BumpArena arena(4096);
+    ArenaStringResource<BumpArena> strings(arena);
+    
+    ArenaString<BumpArena> line(strings);
+    line.reserve(32);
+    const char* buffer = line.data();
+    size_t allocations = arena.allocations();
+    for (int i = 0; i < 100; ++i) {
+        line += "0123456789";
+    }
+    TEST_EQUAL(line.size(), 1000, "Appends should all land");
+    TEST_MESSAGE(line.data() == buffer, "The latest allocation should grow in place");
+    TEST_EQUAL(arena.allocations(), allocations, "Growing in place should not allocate");
+    
+    ArenaString<BumpArena> other(std::string(40, 'o'), strings);
+    line.append(std::string(1000, 'z'));
+    TEST_MESSAGE(line.data() != buffer, "A string that is no longer last should move");
+    TEST_EQUAL(line.view().substr(990, 20), std::string_view("0123456789zzzzzzzzzz"),
+               "Moving should keep the characters");
+    TEST_EQUAL(other.size(), 40, "The string allocated after it should be untouched");
+}
+
+// Test that arena strings are released by resetting the arena
+DEFINE_TEST_G(ArenaReset, MyString) {
+    BumpAllocator<8192> arena;
+    ArenaStringResource<BumpAllocator<8192>> strings(arena);
+    
+    for (int round = 0; round < 3; ++round) {
+        std::vector<ArenaString<BumpAllocator<8192>>> fields;
+        for (int i = 0; i < 50; ++i) {
+            fields.emplace_back(std::string(60, static_cast<char>('a' + i % 26)), strings);
+        }
+        TEST_EQUAL(fields[49].view(), std::string_view(std::string(60, 'x')),
+                   "Strings should read back from the arena");
+        TEST_EQUAL(arena.used(), 50 * 61, "Each string should take exactly its buffer");
+        arena.reset();
+    }
+    TEST_EQUAL(arena.used(), 0, "Reset should release every string at once");
+    
+    
+    BumpAllocator<64> small;
+    ArenaStringResource<BumpAllocator<64>> tight(small);
+    bool thrown = false;
+    try {
+        ArenaString<BumpAllocator<64>> overflow(std::string(100, 'x'), tight);
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    TEST_MESSAGE(thrown, "An exhausted arena should throw std::bad_alloc");
+}
+
+// Test that slices share the parent's characters
+DEFINE_TEST_G(Slices, MyString) {
+    MyString request("GET /api/v1/users?id=42 HTTP/1.1");
+    StringSlice line = request.slice();
+    StringSlice method = line.slice(0, line.find(' '));
+    StringSlice target = line.slice(method.size() + 1, line.rfind(' ') - method.size() - 1);
+    
+    TEST_MESSAGE(method.data() == request.data(), "A slice should point into the string");
+    TEST_MESSAGE(method == "GET" && target == "/api/v1/users?id=42", "Slices should cover the requested range");
+    TEST_MESSAGE(target.starts_with("/api") && target.ends_with("=42") && !target.ends_with("/1.1"),
+                 "starts_with/ends_with should check the slice bounds");
+    
+    StringSlice query = target.slice(target.find('?') + 1);
+    TEST_EQUAL(query.view(), std::string_view("id=42"), "A slice of a slice should stay in the parent");
+    TEST_EQUAL(query.find("42"), 3, "Slice searches should be relative to the slice");
+    TEST_MESSAGE(line.slice(100).empty(), "An out-of-range start should clamp to an empty slice");
+    
+    MyString copy(query);
+    TEST_MESSAGE(copy == "id=42" && copy.data() != query.data(), "Constructing a string should copy a slice");
+}
+
+// Test that materializing makes one exactly-sized allocation
+DEFINE_TEST_G(BuildOnce, StringBuilder) {
+    BumpArena arena(64 * 1024);
+    std::string expected;
+    std::vector<std::string> fields;
+    for (int i = 0; i < 100; ++i) {
+        fields.push_back("field" + std::to_string(i) + "=value;");
+    }
+    
+    StringBuilder<BumpArena> builder(arena);
+    for (const std::string& field : fields) {
+        builder.append(field);
+        expected += field;
+    }
+    TEST_EQUAL(builder.pieces(), 100, "Every piece should be recorded");
+    TEST_EQUAL(builder.size(), expected.size(), "size() should total the pieces");
+    
+    size_t used = arena.used();
+    size_t allocations = arena.allocations();
+    ArenaString<BumpArena> message = builder.build();
+    TEST_EQUAL(message.view(), std::string_view(expected), "build() should concatenate in order");
+    TEST_EQUAL(arena.allocations(), allocations + 1, "build() should allocate once");
+    TEST_EQUAL(arena.used(), used + expected.size() + 1, "The buffer should be exactly the message");
+    
+    StringSlice flat = builder.build_slice();
+    TEST_MESSAGE(flat == expected && flat.data()[flat.size()] == '\0',
+                 "build_slice() should produce a terminated arena copy");
+    
+    StringBuilder<BumpArena> small(arena);
+    small.append("k=").append("v");
+    allocations = arena.allocations();
+    ArenaString<BumpArena> short_result = small.build();
+    TEST_MESSAGE(short_result.is_inline() && arena.allocations() == allocations,
+                 "A short result should stay inline and allocate nothing");
+}
+
+// Test that copied pieces survive their source
+DEFINE_TEST_G(OwnedPieces, StringBuilder) {
+    BumpAllocator<4096> arena;
+    StringBuilder<BumpAllocator<4096>> builder(arena);
+    {
+        std::string temporary = "user=alice";
+        builder.append_copy(temporary).append(' ');
+        temporary.assign(temporary.size(), '#');
+    }
+    builder.append("status=").append_number(404).append(' ').append("bytes=").append_number(-12);
+    TEST_EQUAL(builder.build().view(), std::string_view("user=alice status=404 bytes=-12"),
+               "Copies and formatted numbers should be owned by the arena");
+    
+    builder.clear();
+    TEST_MESSAGE(builder.empty() && builder.pieces() == 0, "clear() should forget every piece");
+}
+
+// Every kernel table this CPU can run
+static std::vector<const StringKernels*> kernel_levels() {
+    std::vector<const StringKernels*> levels;
+    for (StringKernels::Level level : {StringKernels::Level::GENERIC, StringKernels::Level::SSE42,
+                                       StringKernels::Level::AVX2}) {
+        if (StringKernels::supported(level)) {
+            levels.push_back(&StringKernels::get(level));
+        }
+    }
+    return levels;
+}
+
+// Test the searches against std::string_view at every length around the
+// vector widths, with matches at both ends and across chunk boundaries
+DEFINE_TEST_G(SearchMatchesStdString, StringKernels) {
+    uint32_t seed = 12345;
+    auto next = [&seed] {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 16;
+    };
+    
+    for (const StringKernels* kernels : kernel_levels()) {
+        size_t mismatches = 0;
+        for (size_t n = 0; n <= 100; ++n) {
+            // A small alphabet makes partial matches common
+            std::string hay(n, 'a');
+            for (char& ch : hay) {
+                ch = static_cast<char>('a' + next() % 3);
+            }
+            std::string_view view(hay);
+            for (size_t m = 0; m <= 20 && m <= n + 1; ++m) {
+                for (size_t trial = 0; trial < 4; ++trial) {
+                    std::string needle;
+                    if (m <= n && trial < 3) {
+                        size_t at = trial == 0 ? 0 : (trial == 1 ? n - m : next() % (n - m + 1));
+                        needle = hay.substr(at, m);
+                    } else {
+                        needle.assign(m, 'b');
+                        if (m > 0) {
+                            needle[m - 1] = 'z';
+                        }
+                    }
+                    mismatches += kernels->find(hay.data(), n, needle.data(), m) != view.find(needle);
+                    mismatches += kernels->rfind(hay.data(), n, needle.data(), m) != view.rfind(needle);
+                }
+            }
+            for (char ch : {'a', 'b', 'c', 'z'}) {
+                mismatches += kernels->find_char(hay.data(), n, ch) != view.find(ch);
+                mismatches += kernels->rfind_char(hay.data(), n, ch) != view.rfind(ch);
+            }
+        }
+        TEST_EQUAL(mismatches, 0, std::string(kernels->name) + " searches should match std::string_view");
+    }
+    
+    MyString header("Host: example.com\r\nContent-Length: 42\r\n\r\n");
+    TEST_EQUAL(header.find("Content-Length"), 19, "MyString::find() should use the selected kernels");
+    TEST_EQUAL(header.rfind("\r\n", 38), 37, "rfind() should ignore matches starting after pos");
+    TEST_EQUAL(header.find(':', 5), 33, "find(char) should start at pos");
+}
+
+// Test compare/equals on every differing byte position and case folding
+// on every byte value
+DEFINE_TEST_G(CompareAndFold, StringKernels) {
+    std::string all(256, '\0');
+    for (size_t i = 0; i < 256; ++i) {
+        all[i] = static_cast<char>(i);
+    }
+    std::string lower = all, upper = all;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](char ch) {
+        return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch + 32) : ch;
+    });
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](char ch) {
+        return ch >= 'a' && ch <= 'z' ? static_cast<char>(ch - 32) : ch;
+    });
+    
+    for (const StringKernels* kernels : kernel_levels()) {
+        size_t mismatches = 0;
+        for (size_t n = 0; n <= 70; ++n) {
+            std::string a(n, 'x');
+            for (size_t at = 0; at < n; ++at) {
+                std::string b = a;
+                b[at] = static_cast<char>(0xF0);
+                int expected = std::memcmp(a.data(), b.data(), n);
+                int actual = kernels->compare(a.data(), b.data(), n);
+                mismatches += (actual < 0) != (expected < 0) || (actual > 0) != (expected > 0);
+                mismatches += kernels->equals(a.data(), b.data(), n);
+            }
+            mismatches += kernels->compare(a.data(), a.data(), n) != 0 || !kernels->equals(a.data(), a.data(), n);
+        }
+        TEST_EQUAL(mismatches, 0, std::string(kernels->name) + " compare/equals should match memcmp");
+        
+        std::string folded = all;
+        kernels->to_lower(&folded[0], folded.size());
+        TEST_MESSAGE(folded == lower, std::string(kernels->name) + " to_lower should fold only A-Z");
+        folded = all;
+        kernels->to_upper(&folded[0], folded.size());
+        TEST_MESSAGE(folded == upper, std::string(kernels->name) + " to_upper should fold only a-z");
+    }
+    
+    MyString name("X-Forwarded-For");
+    name.to_lower();
+    TEST_MESSAGE(name == "x-forwarded-for" && name < "x-forwarded-fox" && name.compare("x-forwarded") > 0,
+                 "MyString comparisons should use the selected kernels");
+}
+
+// Test that length() stops at a terminator in the last bytes before an
+// unmapped page
+DEFINE_TEST_G(LengthAtPageEnd, StringKernels) {
+#ifdef ARENA_STORAGE_HAS_MMAP
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* mapping = mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_MESSAGE(mapping != MAP_FAILED, "Mapping two pages should succeed");
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+    char* guard = static_cast<char*>(mapping) + page;
+    mprotect(guard, page, PROT_NONE);
+    std::memset(mapping, 'q', page);
+    
+    for (const StringKernels* kernels : kernel_levels()) {
+        size_t mismatches = 0;
+        for (size_t len = 0; len < 100; ++len) {
+            char* str = guard - 1 - len;
+            str[len] = '\0';
+            mismatches += kernels->length(str) != len;
+            str[len] = 'q';
+        }
+        TEST_EQUAL(mismatches, 0, std::string(kernels->name) + " length should match strlen at every alignment");
+    }
+    munmap(mapping, 2 * page);
+#else
+    TEST_MESSAGE(StringKernels::best().length("abc") == 3, "length() should count up to the terminator");
+#endif
+}
+
+DEFINE_TEST_G(CountsHeapCalls, PerfAssertions) {
+    HeapAllocationCounter counter;
+    int* value = new int(7);
+    Benchmark::DoNotOptimize(value);
+    delete value;
+    {
+        std::string text(100, 'x');
+        Benchmark::DoNotOptimize(text.data());
+    }
+    counter.stop();
+    TEST_EQUAL(counter.allocations(), 2, "new and a heap std::string should be counted");
+    TEST_MESSAGE(counter.bytes() >= sizeof(int) + 100, "Requested bytes should be counted");
+    TEST_EQUAL(counter.frees(), 2, "Both deletes should be counted");
+
+    HeapAllocationCounter outer;
+    {
+        HeapAllocationCounter inner;
+        std::unique_ptr<int[]> block(new int[32]);
+        Benchmark::DoNotOptimize(block.get());
+        TEST_EQUAL(inner.allocations(), 1, "A nested counter should see its own allocation");
+    }
+    TEST_EQUAL(outer.allocations(), 1, "The enclosing counter should see it too");
+
+    if (HeapAllocationCounter::hooks_malloc) {
+        HeapAllocationCounter direct;
+        BumpAllocator<256, HeapStorage> heap_backed;
+        Benchmark::DoNotOptimize(heap_backed.alloc<int>());
+        TEST_EQUAL(direct.allocations(), 1, "malloc() in HeapStorage should be counted");
+    }
+
+    size_t other_thread = 0;
+    HeapAllocationCounter local;
+    std::thread([&other_thread] {
+        HeapAllocationCounter worker;
+        std::vector<char> buffer(1 << 20);
+        Benchmark::DoNotOptimize(buffer.data());
+        other_thread = worker.bytes();
+    }).join();
+    TEST_EQUAL(other_thread, size_t(1) << 20, "The worker should count its own allocation");
+    TEST_MESSAGE(local.bytes() < (size_t(1) << 20), "Another thread's allocations should not be counted here");
+}
+
+DEFINE_TEST_G(NoHeapOnHotPath, PerfAssertions) {
+    BumpAllocator<8192> allocator;
+    TEST_NO_HEAP_ALLOC("Bump allocation, creation and reset should stay off the heap") {
+        for (int round = 0; round < 4; ++round) {
+            int* values = allocator.alloc<int>(64);
+            Benchmark::DoNotOptimize(values);
+            Benchmark::DoNotOptimize(allocator.create<std::pair<int, double>>(round, 1.5));
+            Benchmark::DoNotOptimize(allocator.alloc_aligned(100, 64));
+            allocator.reset();
+        }
+    }
+
+    BumpAllocator<8192> strings;
+    size_t expected = 0, built_size = 0;
+    TEST_NO_HEAP_ALLOC("Arena strings and builders should stay off the heap") {
+        ArenaString<BumpAllocator<8192>> line{ArenaStringResource<BumpAllocator<8192>>(strings)};
+        for (int i = 0; i < 20; ++i) {
+            line += "field=";
+            line += 'x';
+        }
+        StringBuilder<BumpAllocator<8192>> builder(strings);
+        builder.append("status=").append_number(200).append(' ').append(line.view());
+        StringSlice built = builder.build_slice();
+        Benchmark::DoNotOptimize(built.data());
+        expected = 11 + line.size();
+        built_size = built.size();
+    }
+    // Reported outside the scope: a buffered report stream may allocate
+    TEST_EQUAL(built_size, expected, "The built line should hold every piece");
+}
+
+DEFINE_TEST_G(BumpBeatsMalloc, PerfAssertions) {
+    BumpAllocator<4096> allocator;
+    void* pointers[64];
+    auto bump = [&] {
+        for (void*& ptr : pointers) {
+            ptr = allocator.alloc_aligned(32, 8);
+        }
+        Benchmark::DoNotOptimize(pointers[63]);
+        allocator.reset();
+    };
+    auto heap = [&] {
+        for (void*& ptr : pointers) {
+            ptr = std::malloc(32);
+        }
+        Benchmark::DoNotOptimize(pointers[63]);
+        for (void* ptr : pointers) {
+            std::free(ptr);
+        }
+    };
+    TEST_FASTER_THAN(bump, heap, 1.0, "64 bump allocations and a reset should not be slower than malloc/free");
+    TEST_WITHIN_BUDGET(bump, std::chrono::microseconds(5), "64 bump allocations and a reset should fit the budget");
+
+    PerfAssert::Config saved = PerfAssert::config();
+    PerfAssert::config().attempts = 1;
+    PerfAssert::Outcome impossible = PerfAssert::within_budget(heap, std::chrono::nanoseconds(0));
+    PerfAssert::config() = saved;
+    TEST_MESSAGE(!impossible.passed, "A zero budget should be reported as exceeded");
+    TEST_MESSAGE(impossible.detail.find("budget 0.0 ns") != std::string::npos,
+                 "The outcome should report the measured time against the budget");
+}
+
+int main(int argc, char** argv) {
+    return TestRunner::Main(argc, argv);
+}
@@ -1,40 +1,100 @@
 #include "task3.hpp"
 #include "task1.hpp"
+#include "chained_arena.hpp"
+#include "bump_resource.hpp"
+#include "pool_allocator.hpp"
+#include "size_class_allocator.hpp"
+#include "concurrent_arena.hpp"
+#include "alloc_trace.hpp"
+#include "double_ended_arena.hpp"
+#include "fiber_stack.hpp"
+#include "fiber_context.hpp"
+#include "fiber_scheduler.hpp"
+#include "fiber_io.hpp"
+#include "my_string.hpp"
+#include "string_simd.hpp"
+#include "string_builder.hpp"
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <map>
+#include <memory_resource>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ucontext.h>
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
 
 // Bump allocator that grows upward
-template<size_t N>
-class BumpUpAllocator : public BumpAllocator<N> {};
+template<size_t N, template<size_t> class Storage = InlineStorage>
+class BumpUpAllocator : public BumpAllocator<N, Storage> {};
 
 // Bump allocator that grows downward
-template<size_t N>
-class BumpDownAllocator {
+template<size_t N, template<size_t> class Storage = InlineStorage>
+class BumpDownAllocator : private BumpStorageHolder<Storage<N>> {
 private:
-    char memory_[N];
+    using Holder = BumpStorageHolder<Storage<N>>;
+
+    char* memory_;
     char* next_;
     size_t allocations_;
+    size_t padding_waste_;
 
 public:
-    BumpDownAllocator() : next_(memory_ + N), allocations_(0) {}
+    struct Marker {
+        char* position;
+        size_t allocations;
+        size_t padding_waste;
+    };
+
+    BumpDownAllocator()
+        : memory_(Holder::storage_.data()), next_(memory_ + N), allocations_(0), padding_waste_(0) {}
+
+    BumpDownAllocator(const BumpDownAllocator&) = delete;
+    BumpDownAllocator& operator=(const BumpDownAllocator&) = delete;
 
     template<typename T>
     T* alloc(size_t n = 1) {
-        size_t size = sizeof(T) * n;
-        
+        if (n > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(alloc_aligned(sizeof(T) * n, alignof(T)));
+    }
+
+    // Aligning downward is a single mask with no padding add; the second
+    // bounds check is against the start of the buffer rather than its end
+    void* alloc_aligned(size_t size, size_t align) {
+        if (align == 0 || (align & (align - 1)) != 0) {
+            return nullptr;
+        }
+
         // Check if we have enough space
-        if (next_ - size < memory_) {
+        if (size > static_cast<size_t>(next_ - memory_)) {
             return nullptr;
         }
-        
-        // Move pointer down
-        next_ -= size;
-        
+
+        // Move pointer down and round it down to the alignment
+        uintptr_t addr = reinterpret_cast<uintptr_t>(next_ - size) & ~(uintptr_t(align) - 1);
+        if (addr < reinterpret_cast<uintptr_t>(memory_)) {
+            return nullptr;
+        }
+
+        char* result = reinterpret_cast<char*>(addr);
+        padding_waste_ += static_cast<size_t>(next_ - result) - size;
+        next_ = result;
+
         // Increment allocation counter
         ++allocations_;
-        
-        return reinterpret_cast<T*>(next_);
+
+        return result;
     }
 
     void dealloc() {
@@ -42,11 +102,119 @@ public:
             --allocations_;
             if (allocations_ == 0) {
                 next_ = memory_ + N;
+                padding_waste_ = 0;
             }
         }
     }
+
+    // Touched pages are the top of the chunk, down to next_
+    void reset() {
+        size_t used = static_cast<size_t>(memory_ + N - next_);
+        Holder::storage_.discard(used);
+        next_ = memory_ + N;
+        allocations_ = 0;
+        padding_waste_ = 0;
+    }
+
+    Marker mark() const {
+        return Marker{next_, allocations_, padding_waste_};
+    }
+
+    void rewind(const Marker& marker) {
+        next_ = marker.position;
+        allocations_ = marker.allocations;
+        padding_waste_ = marker.padding_waste;
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    size_t allocations() const {
+        return allocations_;
+    }
+
+    size_t remaining_space() const {
+        return static_cast<size_t>(next_ - memory_);
+    }
+
+    size_t padding_waste() const {
+        return padding_waste_;
+    }
 };
 
+// Name of the malloc the binary is linked against (see CMakeLists.txt)
+#ifndef TASK3_MALLOC_NAME
+#define TASK3_MALLOC_NAME "malloc"
+#endif
+
+// Run one allocation sequence through the general-purpose allocators the
+// bump allocators are meant to replace. Like the arenas, every baseline
+// frees the whole batch at the end of the run, so each pays for both halves
+// of the allocation life cycle.
+static void run_standard_baselines(const std::string& workload,
+                                   const std::vector<size_t>& sizes,
+                                   const std::vector<size_t>& aligns) {
+    const size_t count = sizes.size();
+    std::vector<void*> ptrs(count);
+
+    auto malloc_test = [&]() {
+        for (size_t i = 0; i < count; ++i) {
+            char* ptr = static_cast<char*>(std::malloc(sizes[i]));
+            if (ptr) ptr[0] = 'a';
+            ptrs[i] = ptr;
+            Benchmark::DoNotOptimize(ptr);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            std::free(ptrs[i]);
+        }
+    };
+
+    auto new_test = [&]() {
+        for (size_t i = 0; i < count; ++i) {
+            char* ptr = static_cast<char*>(::operator new(sizes[i]));
+            ptr[0] = 'a';
+            ptrs[i] = ptr;
+            Benchmark::DoNotOptimize(ptr);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            ::operator delete(ptrs[i]);
+        }
+    };
+
+    auto monotonic_test = [&]() {
+        std::pmr::monotonic_buffer_resource resource;
+        for (size_t i = 0; i < count; ++i) {
+            char* ptr = static_cast<char*>(resource.allocate(sizes[i], aligns[i]));
+            ptr[0] = 'a';
+            Benchmark::DoNotOptimize(ptr);
+        }
+    };
+
+    auto pool_test = [&]() {
+        std::pmr::unsynchronized_pool_resource resource;
+        for (size_t i = 0; i < count; ++i) {
+            char* ptr = static_cast<char*>(resource.allocate(sizes[i], aligns[i]));
+            ptr[0] = 'a';
+            ptrs[i] = ptr;
+            Benchmark::DoNotOptimize(ptr);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            resource.deallocate(ptrs[i], sizes[i], aligns[i]);
+        }
+    };
+
+    auto malloc_result = Benchmark::run(std::string(TASK3_MALLOC_NAME) + "/free - " + workload, malloc_test, 10);
+    auto new_result = Benchmark::run("operator new/delete - " + workload, new_test, 10);
+    auto monotonic_result = Benchmark::run("pmr monotonic_buffer_resource - " + workload, monotonic_test, 10);
+    auto pool_result = Benchmark::run("pmr unsynchronized_pool_resource - " + workload, pool_test, 10);
+
+    Benchmark::print_result(malloc_result);
+    Benchmark::print_result(new_result);
+    Benchmark::print_result(monotonic_result);
+    Benchmark::print_result(pool_result);
+}
+
 // Benchmark functions
 void benchmark_small_allocations(size_t count) {
     constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
@@ -57,6 +225,7 @@ void benchmark_small_allocations(size_t count) {
         for (size_t i = 0; i < count; ++i) {
             auto ptr = up_alloc.alloc<char>();
             if (ptr) *ptr = 'a';
+            Benchmark::DoNotOptimize(ptr);
         }
     };
     
@@ -66,6 +235,7 @@ void benchmark_small_allocations(size_t count) {
         for (size_t i = 0; i < count; ++i) {
             auto ptr = down_alloc.alloc<char>();
             if (ptr) *ptr = 'a';
+            Benchmark::DoNotOptimize(ptr);
         }
     };
     
@@ -74,6 +244,9 @@ void benchmark_small_allocations(size_t count) {
     
     Benchmark::print_result(up_result);
     Benchmark::print_result(down_result);
+
+    run_standard_baselines("Small Allocations", std::vector<size_t>(count, 1),
+                           std::vector<size_t>(count, alignof(char)));
 }
 
 void benchmark_large_allocations(size_t count) {
@@ -86,6 +259,7 @@ void benchmark_large_allocations(size_t count) {
         for (size_t i = 0; i < count; ++i) {
             auto ptr = up_alloc.alloc<char>(ALLOC_SIZE);
             if (ptr) ptr[0] = 'a';
+            Benchmark::DoNotOptimize(ptr);
         }
     };
     
@@ -95,6 +269,7 @@ void benchmark_large_allocations(size_t count) {
         for (size_t i = 0; i < count; ++i) {
             auto ptr = down_alloc.alloc<char>(ALLOC_SIZE);
             if (ptr) ptr[0] = 'a';
+            Benchmark::DoNotOptimize(ptr);
         }
     };
     
@@ -103,6 +278,9 @@ void benchmark_large_allocations(size_t count) {
     
     Benchmark::print_result(up_result);
     Benchmark::print_result(down_result);
+
+    run_standard_baselines("Large Allocations", std::vector<size_t>(count, ALLOC_SIZE),
+                           std::vector<size_t>(count, alignof(char)));
 }
 
 void benchmark_mixed_allocations() {
@@ -115,9 +293,11 @@ void benchmark_mixed_allocations() {
             if (i % 2 == 0) {
                 auto ptr = up_alloc.alloc<char>();
                 if (ptr) *ptr = 'a';
+                Benchmark::DoNotOptimize(ptr);
             } else {
                 auto ptr = up_alloc.alloc<int>();
                 if (ptr) *ptr = 42;
+                Benchmark::DoNotOptimize(ptr);
             }
         }
     };
@@ -129,9 +309,11 @@ void benchmark_mixed_allocations() {
             if (i % 2 == 0) {
                 auto ptr = down_alloc.alloc<char>();
                 if (ptr) *ptr = 'a';
+                Benchmark::DoNotOptimize(ptr);
             } else {
                 auto ptr = down_alloc.alloc<int>();
                 if (ptr) *ptr = 42;
+                Benchmark::DoNotOptimize(ptr);
             }
         }
     };
@@ -141,9 +323,1334 @@ void benchmark_mixed_allocations() {
     
     Benchmark::print_result(up_result);
     Benchmark::print_result(down_result);
+
+    // Same char/int alternation as the bump runs
+    std::vector<size_t> sizes(1000);
+    std::vector<size_t> aligns(1000);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        sizes[i] = i % 2 == 0 ? sizeof(char) : sizeof(int);
+        aligns[i] = i % 2 == 0 ? alignof(char) : alignof(int);
+    }
+    run_standard_baselines("Mixed Allocations", sizes, aligns);
+}
+
+void benchmark_aligned_allocations(size_t count) {
+    constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
+    constexpr size_t ALLOC_SIZE = 48;          // Not a multiple of the alignment
+    constexpr size_t ALIGNMENT = 64;           // Cache-line aligned
+    
+    size_t up_waste = 0;
+    size_t down_waste = 0;
+    
+    // Test BumpUpAllocator
+    auto up_test = [count, &up_waste]() {
+        BumpUpAllocator<HEAP_SIZE> up_alloc;
+        for (size_t i = 0; i < count; ++i) {
+            auto ptr = static_cast<char*>(up_alloc.alloc_aligned(ALLOC_SIZE, ALIGNMENT));
+            if (ptr) ptr[0] = 'a';
+            Benchmark::DoNotOptimize(ptr);
+        }
+        up_waste = up_alloc.padding_waste();
+    };
+    
+    // Test BumpDownAllocator
+    auto down_test = [count, &down_waste]() {
+        BumpDownAllocator<HEAP_SIZE> down_alloc;
+        for (size_t i = 0; i < count; ++i) {
+            auto ptr = static_cast<char*>(down_alloc.alloc_aligned(ALLOC_SIZE, ALIGNMENT));
+            if (ptr) ptr[0] = 'a';
+            Benchmark::DoNotOptimize(ptr);
+        }
+        down_waste = down_alloc.padding_waste();
+    };
+    
+    auto up_result = Benchmark::run("BumpUpAllocator - Aligned Allocations", up_test, 10);
+    auto down_result = Benchmark::run("BumpDownAllocator - Aligned Allocations", down_test, 10);
+    
+    Benchmark::print_result(up_result);
+    Benchmark::print_result(down_result);
+    std::cout << "Padding waste: up " << up_waste << " bytes, down " << down_waste << " bytes\n";
+}
+
+void benchmark_chained_allocations(size_t count) {
+    constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
+    constexpr size_t BLOCK_SIZE = 4096;        // 4KB first block
+    
+    // Test BumpUpAllocator sized for the worst case
+    auto fixed_test = [count]() {
+        BumpUpAllocator<HEAP_SIZE> up_alloc;
+        for (size_t i = 0; i < count; ++i) {
+            auto ptr = up_alloc.alloc<int>();
+            if (ptr) *ptr = 42;
+            Benchmark::DoNotOptimize(ptr);
+        }
+    };
+    
+    // Test ChainedBumpAllocator starting small and growing on demand
+    ChainedBumpAllocator<> chained_alloc(BLOCK_SIZE, HEAP_SIZE);
+    auto chained_test = [count, &chained_alloc]() {
+        for (size_t i = 0; i < count; ++i) {
+            auto ptr = chained_alloc.alloc<int>();
+            if (ptr) *ptr = 42;
+            Benchmark::DoNotOptimize(ptr);
+        }
+        chained_alloc.reset();
+    };
+    
+    auto fixed_result = Benchmark::run("BumpUpAllocator - Fixed 1MB", fixed_test, 10);
+    auto chained_result = Benchmark::run("ChainedBumpAllocator - Growable from 4KB", chained_test, 10);
+    
+    Benchmark::print_result(fixed_result);
+    Benchmark::print_result(chained_result);
+}
+
+void benchmark_phased_allocations(size_t messages) {
+    constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
+    constexpr size_t PHASES = 3;               // Phases per message
+    constexpr size_t PHASE_SIZE = 1024;        // 1KB per phase
+    
+    size_t flat_peak = 0;
+    size_t scoped_peak = 0;
+    
+    // Without rewind every phase stays live until the arena is destroyed
+    auto flat_test = [messages, &flat_peak]() {
+        BumpDownAllocator<HEAP_SIZE> down_alloc;
+        for (size_t m = 0; m < messages; ++m) {
+            for (size_t p = 0; p < PHASES; ++p) {
+                auto ptr = down_alloc.alloc<char>(PHASE_SIZE);
+                if (ptr) ptr[0] = 'a';
+                Benchmark::DoNotOptimize(ptr);
+            }
+        }
+        flat_peak = down_alloc.capacity() - down_alloc.remaining_space();
+    };
+    
+    // Each phase is rewound as soon as it finishes
+    auto scoped_test = [messages, &scoped_peak]() {
+        BumpDownAllocator<HEAP_SIZE> down_alloc;
+        for (size_t m = 0; m < messages; ++m) {
+            for (size_t p = 0; p < PHASES; ++p) {
+                ArenaScope<BumpDownAllocator<HEAP_SIZE>> scope(down_alloc);
+                auto ptr = down_alloc.alloc<char>(PHASE_SIZE);
+                if (ptr) ptr[0] = 'a';
+                Benchmark::DoNotOptimize(ptr);
+                size_t used = down_alloc.capacity() - down_alloc.remaining_space();
+                if (used > scoped_peak) scoped_peak = used;
+            }
+        }
+    };
+    
+    auto flat_result = Benchmark::run("BumpDownAllocator - No Rewind", flat_test, 10);
+    auto scoped_result = Benchmark::run("BumpDownAllocator - ArenaScope Per Phase", scoped_test, 10);
+    
+    Benchmark::print_result(flat_result);
+    Benchmark::print_result(scoped_result);
+    std::cout << "Peak usage: no rewind " << flat_peak << " bytes, scoped " << scoped_peak << " bytes\n";
+}
+
+void benchmark_container_allocations(size_t count) {
+    constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
+    
+    // std::vector push_back
+    auto vector_std_test = [count]() {
+        std::vector<int> values;
+        for (size_t i = 0; i < count; ++i) values.push_back(static_cast<int>(i));
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    auto vector_monotonic_test = [count]() {
+        std::pmr::monotonic_buffer_resource resource(HEAP_SIZE);
+        std::pmr::vector<int> values(&resource);
+        for (size_t i = 0; i < count; ++i) values.push_back(static_cast<int>(i));
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    auto vector_up_test = [count]() {
+        BumpUpAllocator<HEAP_SIZE> up_alloc;
+        BumpMemoryResource<BumpUpAllocator<HEAP_SIZE>> resource(up_alloc);
+        std::pmr::vector<int> values(&resource);
+        for (size_t i = 0; i < count; ++i) values.push_back(static_cast<int>(i));
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    auto vector_down_test = [count]() {
+        BumpDownAllocator<HEAP_SIZE> down_alloc;
+        BumpMemoryResource<BumpDownAllocator<HEAP_SIZE>> resource(down_alloc);
+        std::pmr::vector<int> values(&resource);
+        for (size_t i = 0; i < count; ++i) values.push_back(static_cast<int>(i));
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    auto vector_stl_test = [count]() {
+        BumpUpAllocator<HEAP_SIZE> up_alloc;
+        using Alloc = BumpStlAllocator<int, BumpUpAllocator<HEAP_SIZE>>;
+        std::vector<int, Alloc> values{Alloc(up_alloc)};
+        for (size_t i = 0; i < count; ++i) values.push_back(static_cast<int>(i));
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    // std::map insert
+    auto map_std_test = [count]() {
+        std::map<size_t, size_t> values;
+        for (size_t i = 0; i < count; ++i) values.emplace(i, i);
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    auto map_monotonic_test = [count]() {
+        std::pmr::monotonic_buffer_resource resource(HEAP_SIZE);
+        std::pmr::map<size_t, size_t> values(&resource);
+        for (size_t i = 0; i < count; ++i) values.emplace(i, i);
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    auto map_up_test = [count]() {
+        BumpUpAllocator<HEAP_SIZE> up_alloc;
+        BumpMemoryResource<BumpUpAllocator<HEAP_SIZE>> resource(up_alloc);
+        std::pmr::map<size_t, size_t> values(&resource);
+        for (size_t i = 0; i < count; ++i) values.emplace(i, i);
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    auto map_down_test = [count]() {
+        BumpDownAllocator<HEAP_SIZE> down_alloc;
+        BumpMemoryResource<BumpDownAllocator<HEAP_SIZE>> resource(down_alloc);
+        std::pmr::map<size_t, size_t> values(&resource);
+        for (size_t i = 0; i < count; ++i) values.emplace(i, i);
+        Benchmark::DoNotOptimize(values);
+    };
+    
+    std::vector<Benchmark::Result> results;
+    results.push_back(Benchmark::run("std::allocator - vector push_back", vector_std_test, 10));
+    results.push_back(Benchmark::run("pmr::monotonic_buffer_resource - vector push_back", vector_monotonic_test, 10));
+    results.push_back(Benchmark::run("BumpUpAllocator (pmr) - vector push_back", vector_up_test, 10));
+    results.push_back(Benchmark::run("BumpDownAllocator (pmr) - vector push_back", vector_down_test, 10));
+    results.push_back(Benchmark::run("BumpUpAllocator (BumpStlAllocator) - vector push_back", vector_stl_test, 10));
+    results.push_back(Benchmark::run("std::allocator - map insert", map_std_test, 10));
+    results.push_back(Benchmark::run("pmr::monotonic_buffer_resource - map insert", map_monotonic_test, 10));
+    results.push_back(Benchmark::run("BumpUpAllocator (pmr) - map insert", map_up_test, 10));
+    results.push_back(Benchmark::run("BumpDownAllocator (pmr) - map insert", map_down_test, 10));
+    
+    for (const auto& result : results) {
+        Benchmark::print_result(result);
+    }
+}
+
+struct Session {
+    uint64_t id;
+    double last_seen;
+    char peer[48];
+};
+
+void benchmark_pool_churn(size_t count) {
+    constexpr size_t LIVE = 256;  // Objects alive at any time
+    
+    // Replace a pseudo-random live object on every step
+    auto pool_test = [count]() {
+        PoolAllocator<Session> pool;
+        Session* live[LIVE] = {};
+        uint32_t state = 12345;
+        for (size_t i = 0; i < count; ++i) {
+            state = state * 1103515245u + 12345u;
+            size_t slot = (state >> 16) % LIVE;
+            pool.dealloc(live[slot]);
+            live[slot] = pool.alloc();
+            if (live[slot]) live[slot]->id = i;
+            Benchmark::DoNotOptimize(live[slot]);
+        }
+    };
+    
+    auto malloc_test = [count]() {
+        Session* live[LIVE] = {};
+        uint32_t state = 12345;
+        for (size_t i = 0; i < count; ++i) {
+            state = state * 1103515245u + 12345u;
+            size_t slot = (state >> 16) % LIVE;
+            std::free(live[slot]);
+            live[slot] = static_cast<Session*>(std::malloc(sizeof(Session)));
+            if (live[slot]) live[slot]->id = i;
+            Benchmark::DoNotOptimize(live[slot]);
+        }
+        for (Session* s : live) std::free(s);
+    };
+    
+    auto pool_result = Benchmark::run("PoolAllocator - Alloc/Free Churn", pool_test, 10);
+    auto malloc_result = Benchmark::run("malloc/free - Alloc/Free Churn", malloc_test, 10);
+    
+    Benchmark::print_result(pool_result);
+    Benchmark::print_result(malloc_result);
+}
+
+void benchmark_size_class_churn(size_t count) {
+    constexpr size_t LIVE = 256;  // Objects alive at any time
+    
+    SizeClassAllocator<> size_class_alloc;
+    
+    // Replace a pseudo-random live char or int array on every step
+    auto size_class_test = [count, &size_class_alloc]() {
+        void* live[LIVE] = {};
+        size_t sizes[LIVE] = {};
+        uint32_t state = 12345;
+        for (size_t i = 0; i < count; ++i) {
+            state = state * 1103515245u + 12345u;
+            size_t slot = (state >> 16) % LIVE;
+            size_class_alloc.dealloc(live[slot], sizes[slot]);
+            sizes[slot] = (i % 2 == 0) ? 1 + (state & 63) : sizeof(int) * (1 + (state & 31));
+            live[slot] = size_class_alloc.alloc_aligned(sizes[slot], alignof(int));
+            if (live[slot]) static_cast<char*>(live[slot])[0] = 'a';
+            Benchmark::DoNotOptimize(live[slot]);
+        }
+        for (size_t slot = 0; slot < LIVE; ++slot) {
+            size_class_alloc.dealloc(live[slot], sizes[slot]);
+        }
+    };
+    
+    auto malloc_test = [count]() {
+        void* live[LIVE] = {};
+        uint32_t state = 12345;
+        for (size_t i = 0; i < count; ++i) {
+            state = state * 1103515245u + 12345u;
+            size_t slot = (state >> 16) % LIVE;
+            std::free(live[slot]);
+            size_t size = (i % 2 == 0) ? 1 + (state & 63) : sizeof(int) * (1 + (state & 31));
+            live[slot] = std::malloc(size);
+            if (live[slot]) static_cast<char*>(live[slot])[0] = 'a';
+            Benchmark::DoNotOptimize(live[slot]);
+        }
+        for (void* ptr : live) std::free(ptr);
+    };
+    
+    auto size_class_result = Benchmark::run("SizeClassAllocator - Mixed Churn", size_class_test, 10);
+    auto malloc_result = Benchmark::run("malloc/free - Mixed Churn", malloc_test, 10);
+    
+    Benchmark::print_result(size_class_result);
+    Benchmark::print_result(malloc_result);
+    
+    std::cout << "Size class occupancy (block size: free blocks / chunks):\n";
+    for (size_t i = 0; i < size_class_alloc.class_count(); ++i) {
+        auto stats = size_class_alloc.class_stats(i);
+        std::cout << "  " << stats.block_size << " bytes: "
+                  << stats.free << " / " << stats.chunks << "\n";
+    }
+}
+
+// Fill an arena with 64-byte nodes, then chase pseudo-random nodes across it
+template<typename Arena>
+static Benchmark::Result run_storage_benchmark(const std::string& name, Arena& arena, size_t reads) {
+    constexpr size_t NODE_SIZE = 64;
+    
+    std::vector<char*> nodes;
+    nodes.reserve(arena.capacity() / NODE_SIZE);
+    while (char* node = static_cast<char*>(arena.alloc_aligned(NODE_SIZE, NODE_SIZE))) {
+        node[0] = 1;
+        nodes.push_back(node);
+    }
+    
+    size_t sum = 0;
+    auto read_test = [reads, &nodes, &sum]() {
+        uint32_t state = 12345;
+        for (size_t i = 0; i < reads; ++i) {
+            state = state * 1103515245u + 12345u;
+            sum += static_cast<size_t>(nodes[state % nodes.size()][0]);
+        }
+        Benchmark::DoNotOptimize(sum);
+    };
+    
+    auto result = Benchmark::run(name, read_test, 10);
+    arena.reset();
+    return result;
+}
+
+void benchmark_storage_policies(size_t reads) {
+    constexpr size_t ARENA_SIZE = 64 * 1024 * 1024;  // 64MB arena
+    
+    std::vector<Benchmark::Result> results;
+    {
+        BumpUpAllocator<ARENA_SIZE, HeapStorage> heap_alloc;
+        results.push_back(run_storage_benchmark("BumpUpAllocator<HeapStorage> - Random Reads", heap_alloc, reads));
+    }
+#ifdef ARENA_STORAGE_HAS_MMAP
+    {
+        BumpUpAllocator<ARENA_SIZE, MmapStorage> mmap_alloc;
+        results.push_back(run_storage_benchmark("BumpUpAllocator<MmapStorage> - Random Reads", mmap_alloc, reads));
+    }
+    {
+        BumpUpAllocator<ARENA_SIZE, HugePageStorage> huge_alloc;
+        std::string name = huge_alloc.storage().hugetlb()
+                               ? "BumpUpAllocator<HugePageStorage, hugetlb> - Random Reads"
+                               : "BumpUpAllocator<HugePageStorage, THP> - Random Reads";
+        results.push_back(run_storage_benchmark(name, huge_alloc, reads));
+    }
+    {
+        BumpDownAllocator<ARENA_SIZE, HugePageStorage> huge_down_alloc;
+        results.push_back(run_storage_benchmark("BumpDownAllocator<HugePageStorage> - Random Reads", huge_down_alloc, reads));
+    }
+#endif
+    
+    for (const auto& result : results) {
+        Benchmark::print_result(result);
+    }
+}
+
+void benchmark_batch_allocations(size_t count) {
+    constexpr size_t HEAP_SIZE = 1024 * 1024;  // 1MB heap
+    
+    std::vector<char*> ptrs(count);
+    
+    // One bounds check and counter bump per object
+    auto single_test = [count, &ptrs]() {
+        BumpUpAllocator<HEAP_SIZE> up_alloc;
+        for (size_t i = 0; i < count; ++i) {
+            ptrs[i] = up_alloc.alloc<char>();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (ptrs[i]) *ptrs[i] = 'a';
+        }
+    };
+    
+    // One bounds check for the whole batch
+    auto batch_test = [count, &ptrs]() {
+        BumpUpAllocator<HEAP_SIZE> up_alloc;
+        if (up_alloc.alloc_batch(count, ptrs.data())) {
+            for (size_t i = 0; i < count; ++i) {
+                *ptrs[i] = 'a';
+            }
+        }
+    };
+    
+    // Reserve once, then carve without checks
+    auto reserve_test = [count, &ptrs]() {
+        BumpUpAllocator<HEAP_SIZE> up_alloc;
+        BumpSpan span = up_alloc.reserve(count);
+        if (span) {
+            for (size_t i = 0; i < count; ++i) {
+                ptrs[i] = span.take<char>();
+            }
+            for (size_t i = 0; i < count; ++i) {
+                *ptrs[i] = 'a';
+            }
+        }
+    };
+    
+    auto single_result = Benchmark::run("BumpUpAllocator - Per-Allocation", single_test, 10);
+    auto batch_result = Benchmark::run("BumpUpAllocator - alloc_batch", batch_test, 10);
+    auto reserve_result = Benchmark::run("BumpUpAllocator - reserve + take", reserve_test, 10);
+    
+    Benchmark::print_result(single_result);
+    Benchmark::print_result(batch_result);
+    Benchmark::print_result(reserve_result);
+}
+
+// Time `workload` on 1, 2, 4, ... max_threads threads and print throughput.
+// `setup` runs single-threaded before every run. Only the go-to-join window
+// of measure_threads() is recorded, so setup and thread spawn are excluded.
+template<typename Workload, typename Setup>
+static void run_thread_scaling(const std::string& name, size_t max_threads,
+                               size_t ops_per_thread, Workload&& workload, Setup&& setup) {
+    std::vector<size_t> counts;
+    for (size_t t = 1; t < max_threads; t *= 2) counts.push_back(t);
+    counts.push_back(max_threads);
+    
+    for (size_t threads : counts) {
+        auto test = [threads, &workload, &setup]() {
+            setup();
+            return Benchmark::measure_threads(threads, workload);
+        };
+        auto result = Benchmark::run_timed(name + " - " + std::to_string(threads) + " threads", test, 5);
+        Benchmark::print_result(result);
+        
+        double ops = static_cast<double>(threads * ops_per_thread);
+        std::cout << "    throughput: " << ops / result.median_ns * 1e3 << " Mops/s\n";
+    }
+}
+
+template<typename Workload>
+static void run_thread_scaling(const std::string& name, size_t max_threads,
+                               size_t ops_per_thread, Workload&& workload) {
+    run_thread_scaling(name, max_threads, ops_per_thread, workload, []() {});
+}
+
+void benchmark_thread_scaling(size_t max_threads) {
+    constexpr size_t OPS = 10000;         // Allocations per thread per run
+    constexpr size_t GROUP = 256;         // Allocations live at once
+    constexpr size_t OBJECT_SIZE = 64;
+    constexpr size_t SHARED_SIZE = 64 * 1024 * 1024;
+    
+    // Per-thread arenas refilled from the lock-free chunk pool
+    ChunkPool pool(64 * 1024, static_cast<uint32_t>(max_threads * 4));
+    run_thread_scaling("ThreadLocalArena", max_threads, OPS, [&pool](size_t) {
+        ThreadLocalArena& arena = ThreadLocalArena::local(pool);
+        for (size_t i = 0; i < OPS; i += GROUP) {
+            for (size_t j = 0; j < GROUP; ++j) {
+                Benchmark::DoNotOptimize(arena.alloc_aligned(OBJECT_SIZE, 8));
+            }
+            arena.reset();
+        }
+    });
+    
+    // One arena shared through fetch_add, reset between runs
+    std::unique_ptr<AtomicBumpAllocator<SHARED_SIZE>> shared(new AtomicBumpAllocator<SHARED_SIZE>());
+    size_t shared_threads = std::min(max_threads, SHARED_SIZE / (OPS * (OBJECT_SIZE + 7)));
+    run_thread_scaling("AtomicBumpAllocator", shared_threads, OPS, [&shared](size_t) {
+        for (size_t i = 0; i < OPS; ++i) {
+            Benchmark::DoNotOptimize(shared->alloc_aligned(OBJECT_SIZE, 8));
+        }
+    }, [&shared]() { shared->reset(); });
+    
+    run_thread_scaling("malloc/free", max_threads, OPS, [](size_t) {
+        void* live[GROUP];
+        for (size_t i = 0; i < OPS; i += GROUP) {
+            for (size_t j = 0; j < GROUP; ++j) live[j] = std::malloc(OBJECT_SIZE);
+            Benchmark::DoNotOptimize(live);
+            for (size_t j = 0; j < GROUP; ++j) std::free(live[j]);
+        }
+    });
+    
+    std::pmr::synchronized_pool_resource pmr_pool;
+    run_thread_scaling("pmr::synchronized_pool_resource", max_threads, OPS, [&pmr_pool](size_t) {
+        void* live[GROUP];
+        for (size_t i = 0; i < OPS; i += GROUP) {
+            for (size_t j = 0; j < GROUP; ++j) live[j] = pmr_pool.allocate(OBJECT_SIZE, 8);
+            Benchmark::DoNotOptimize(live);
+            for (size_t j = 0; j < GROUP; ++j) pmr_pool.deallocate(live[j], OBJECT_SIZE, 8);
+        }
+    });
+}
+
+// malloc for trace events, falling back to aligned_alloc for over-aligned ones
+static void* trace_malloc(size_t size, size_t align) {
+    if (align <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    return std::aligned_alloc(align, (size + align - 1) & ~(align - 1));
+}
+
+// Replay the same trace through every general-purpose allocator. Bump
+// arenas only reclaim on reset, so they are sized from the trace up front.
+void benchmark_trace_replay(const AllocTrace& trace) {
+    TraceReplay replay(trace);
+    size_t failures = 0;
+    std::cout << trace.size() << " allocations on " << trace.thread_count() << " threads, "
+              << replay.peak_bytes() / 1024 << "KB peak live, "
+              << trace.total_bytes() / 1024 << "KB total\n";
+    
+    BumpArena arena(trace.total_bytes());
+    auto arena_test = [&]() {
+        failures += replay.run([&](size_t size, size_t align) { return arena.alloc_aligned(size, align); },
+                               [&](void*, size_t, size_t) { arena.dealloc(); });
+        arena.reset();
+    };
+    
+    ChainedBumpAllocator<> chained;
+    auto chained_test = [&]() {
+        failures += replay.run([&](size_t size, size_t align) { return chained.alloc_aligned(size, align); },
+                               [&](void*, size_t, size_t) { chained.dealloc(); });
+        chained.reset();
+    };
+    
+    // Requests above the largest class go to malloc, as they would in use
+    SizeClassAllocator<> size_class;
+    auto size_class_test = [&]() {
+        failures += replay.run([&](size_t size, size_t align) {
+            return size > size_class.max_size() ? std::malloc(size) : size_class.alloc_aligned(size, align);
+        }, [&](void* ptr, size_t size, size_t align) {
+            if (size > size_class.max_size()) {
+                std::free(ptr);
+            } else {
+                size_class.dealloc(ptr, size, align);
+            }
+        });
+    };
+    
+    auto malloc_test = [&]() {
+        failures += replay.run(trace_malloc, [](void* ptr, size_t, size_t) { std::free(ptr); });
+    };
+    
+    auto new_test = [&]() {
+        failures += replay.run([](size_t size, size_t align) { return ::operator new(size, std::align_val_t(align)); },
+                               [](void* ptr, size_t, size_t align) { ::operator delete(ptr, std::align_val_t(align)); });
+    };
+    
+    std::pmr::unsynchronized_pool_resource pool;
+    auto pool_test = [&]() {
+        failures += replay.run([&](size_t size, size_t align) { return pool.allocate(size, align); },
+                               [&](void* ptr, size_t size, size_t align) { pool.deallocate(ptr, size, align); });
+    };
+    
+    auto monotonic_test = [&]() {
+        std::pmr::monotonic_buffer_resource monotonic;
+        failures += replay.run([&](size_t size, size_t align) { return monotonic.allocate(size, align); },
+                               [](void*, size_t, size_t) {});
+    };
+    
+    auto arena_result = Benchmark::run("BumpArena - Trace Replay", arena_test, 10);
+    auto chained_result = Benchmark::run("ChainedBumpAllocator - Trace Replay", chained_test, 10);
+    auto size_class_result = Benchmark::run("SizeClassAllocator - Trace Replay", size_class_test, 10);
+    auto malloc_result = Benchmark::run(std::string(TASK3_MALLOC_NAME) + "/free - Trace Replay", malloc_test, 10);
+    auto new_result = Benchmark::run("operator new/delete - Trace Replay", new_test, 10);
+    auto pool_result = Benchmark::run("pmr unsynchronized_pool_resource - Trace Replay", pool_test, 10);
+    auto monotonic_result = Benchmark::run("pmr monotonic_buffer_resource - Trace Replay", monotonic_test, 10);
+    
+    Benchmark::print_result(arena_result);
+    Benchmark::print_result(chained_result);
+    Benchmark::print_result(size_class_result);
+    Benchmark::print_result(malloc_result);
+    Benchmark::print_result(new_result);
+    Benchmark::print_result(pool_result);
+    Benchmark::print_result(monotonic_result);
+    if (failures > 0) {
+        std::cout << "Failed allocations: " << failures << "\n";
+    }
+    
+    if (trace.thread_count() < 2) {
+        return;
+    }
+    
+    // Each thread replays its own events concurrently
+    size_t threads = trace.thread_count();
+    std::vector<std::unique_ptr<TraceReplay>> replays;
+    size_t max_thread_bytes = 0;
+    for (size_t t = 0; t < threads; ++t) {
+        replays.emplace_back(new TraceReplay(trace, static_cast<int>(t)));
+        max_thread_bytes = std::max(max_thread_bytes, trace.total_bytes(static_cast<int>(t)));
+    }
+    
+    // Chunks must fit the largest request; enough of them for every thread's
+    // whole replay. The pool indexes chunks in 32 bits (UINT32_MAX marks an
+    // empty stack), so a count that would not fit is skipped, not truncated
+    constexpr size_t CHUNK_SIZE = 256 * 1024;
+    size_t chunk_count = threads * (max_thread_bytes / (CHUNK_SIZE / 2) + 2);
+    if (chunk_count >= UINT32_MAX) {
+        std::cout << "Skipping concurrent replay: " << chunk_count << " chunks exceed the pool's 32-bit index\n";
+        return;
+    }
+    ChunkPool chunk_pool(CHUNK_SIZE, static_cast<uint32_t>(chunk_count));
+    auto local_test = [&]() {
+        return Benchmark::measure_threads(threads, [&](size_t t) {
+            ThreadLocalArena& local = ThreadLocalArena::local(chunk_pool);
+            replays[t]->run([&](size_t size, size_t align) { return local.alloc_aligned(size, align); },
+                            [&](void*, size_t, size_t) { local.dealloc(); });
+            local.reset();
+        });
+    };
+    
+    auto threaded_malloc_test = [&]() {
+        return Benchmark::measure_threads(threads, [&](size_t t) {
+            replays[t]->run(trace_malloc, [](void* ptr, size_t, size_t) { std::free(ptr); });
+        });
+    };
+    
+    std::pmr::synchronized_pool_resource shared_pool;
+    auto shared_pool_test = [&]() {
+        return Benchmark::measure_threads(threads, [&](size_t t) {
+            replays[t]->run([&](size_t size, size_t align) { return shared_pool.allocate(size, align); },
+                            [&](void* ptr, size_t size, size_t align) { shared_pool.deallocate(ptr, size, align); });
+        });
+    };
+    
+    std::string suffix = " - Trace Replay " + std::to_string(threads) + " threads";
+    // Record only the go-to-join window, not thread spawn and join
+    auto local_result = Benchmark::run_timed("ThreadLocalArena" + suffix, local_test, 5);
+    auto threaded_malloc_result = Benchmark::run_timed(std::string(TASK3_MALLOC_NAME) + "/free" + suffix, threaded_malloc_test, 5);
+    auto shared_pool_result = Benchmark::run_timed("pmr::synchronized_pool_resource" + suffix, shared_pool_test, 5);
+    
+    Benchmark::print_result(local_result);
+    Benchmark::print_result(threaded_malloc_result);
+    Benchmark::print_result(shared_pool_result);
+}
+
+// Frame loop with two lifetimes: a few long-lived blocks kept across
+// frames and per-frame temporaries dropped at the end of each frame
+void benchmark_double_ended(size_t frames) {
+    constexpr size_t HEAP_SIZE = 128 * 1024;  // Per arena
+    constexpr size_t KEPT = 10;               // 64-byte blocks kept per frame
+    constexpr size_t TEMPS = 50;              // 256-byte temporaries per frame
+    
+    // Separate up and down allocators, one buffer per lifetime
+    auto split_test = [frames]() {
+        BumpUpAllocator<HEAP_SIZE> kept;
+        BumpDownAllocator<HEAP_SIZE> temps;
+        for (size_t frame = 0; frame < frames; ++frame) {
+            for (size_t i = 0; i < TEMPS; ++i) {
+                char* temp = temps.alloc<char>(256);
+                if (temp) temp[0] = 'a';
+                Benchmark::DoNotOptimize(temp);
+                if (i % (TEMPS / KEPT) == 0) {
+                    char* block = kept.alloc<char>(64);
+                    if (block) block[0] = temp ? temp[0] : 0;
+                    Benchmark::DoNotOptimize(block);
+                }
+            }
+            temps.reset();
+        }
+    };
+    
+    // One buffer: kept blocks from the bottom, temporaries from the top
+    auto shared_test = [frames]() {
+        DoubleEndedArena<HEAP_SIZE> arena;
+        for (size_t frame = 0; frame < frames; ++frame) {
+            for (size_t i = 0; i < TEMPS; ++i) {
+                char* temp = arena.top().alloc<char>(256);
+                if (temp) temp[0] = 'a';
+                Benchmark::DoNotOptimize(temp);
+                if (i % (TEMPS / KEPT) == 0) {
+                    char* block = arena.bottom().alloc<char>(64);
+                    if (block) block[0] = temp ? temp[0] : 0;
+                    Benchmark::DoNotOptimize(block);
+                }
+            }
+            arena.top().reset();
+        }
+    };
+    
+    auto split_result = Benchmark::run("BumpUp + BumpDown - Two Lifetimes", split_test, 10);
+    auto shared_result = Benchmark::run("DoubleEndedArena - Two Lifetimes", shared_test, 10);
+    
+    Benchmark::print_result(split_result);
+    Benchmark::print_result(shared_result);
+    std::cout << "Reserved: split " << 2 * HEAP_SIZE / 1024 << "KB, double-ended "
+              << HEAP_SIZE / 1024 << "KB\n";
 }
 
-int main() {
+// Spawn-time stack cost: hand out `count` guarded stacks, touch the top
+// page as a starting fiber would, then give them all back
+void benchmark_fiber_stacks(size_t count) {
+#ifdef ARENA_STORAGE_HAS_MMAP
+    constexpr size_t STACK_SIZE = 64 * 1024;
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<FiberStack> stacks(count);
+    
+    FiberStackPool pool(STACK_SIZE, count);
+    auto pool_test = [&]() {
+        for (size_t i = 0; i < count; ++i) {
+            stacks[i] = pool.acquire();
+            if (stacks[i]) stacks[i].top()[-1] = 'a';
+        }
+        for (size_t i = 0; i < count; ++i) {
+            pool.release(stacks[i]);
+        }
+    };
+    
+    // One mapping per stack, with its own guard page
+    auto mmap_test = [&]() {
+        for (size_t i = 0; i < count; ++i) {
+            void* ptr = mmap(nullptr, STACK_SIZE + page, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED) {
+                stacks[i] = FiberStack{nullptr, 0};
+                continue;
+            }
+            mprotect(ptr, page, PROT_NONE);
+            stacks[i] = FiberStack{static_cast<char*>(ptr) + page, STACK_SIZE};
+            stacks[i].top()[-1] = 'a';
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (stacks[i]) munmap(stacks[i].base - page, STACK_SIZE + page);
+        }
+    };
+    
+    auto pool_result = Benchmark::run("FiberStackPool - Acquire/Release", pool_test, 10);
+    auto mmap_result = Benchmark::run("mmap per stack - Map/Unmap", mmap_test, 10);
+    
+    Benchmark::print_result(pool_result);
+    Benchmark::print_result(mmap_result);
+#else
+    (void)count;
+    std::cout << "mmap is not available on this platform\n";
+#endif
+}
+
+#if defined(__x86_64__)
+// Bytes needed by xsave for every state component the OS has enabled, or 0
+// without OS support for xsave
+static size_t xsave_area_size() {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || (ecx & bit_OSXSAVE) == 0) {
+        return 0;
+    }
+    __cpuid_count(0xD, 0, eax, ebx, ecx, edx);
+    return ebx;
+}
+
+static uint64_t enabled_xstate() {
+    uint32_t low, high;
+    asm volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (static_cast<uint64_t>(high) << 32) | low;
+}
+#endif
+
+// Partner for the thread handoff tests: answers every ping with a pong
+class ThreadPingPong {
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<uint64_t> ping_;
+    std::atomic<uint64_t> pong_;
+    std::atomic<bool> stop_;
+    bool spin_;
+    std::thread thread_;
+
+    void serve() {
+        uint64_t seen = 0;
+        while (true) {
+            if (spin_) {
+                while (ping_.load(std::memory_order_acquire) == seen && !stop_.load(std::memory_order_relaxed)) {
+                    std::this_thread::yield();
+                }
+            } else {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return ping_.load(std::memory_order_relaxed) != seen || stop_.load(); });
+            }
+            if (stop_.load()) {
+                return;
+            }
+            seen = ping_.load(std::memory_order_relaxed);
+            if (spin_) {
+                pong_.store(seen, std::memory_order_release);
+            } else {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pong_.store(seen, std::memory_order_relaxed);
+                cv_.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit ThreadPingPong(bool spin)
+        : ping_(0), pong_(0), stop_(false), spin_(spin), thread_([this] { serve(); }) {}
+
+    ~ThreadPingPong() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_.store(true);
+            cv_.notify_all();
+        }
+        thread_.join();
+    }
+
+    // One round trip: wake the partner and wait for its reply
+    void round_trip() {
+        uint64_t next = ping_.load(std::memory_order_relaxed) + 1;
+        if (spin_) {
+            ping_.store(next, std::memory_order_release);
+            while (pong_.load(std::memory_order_acquire) != next) {
+                std::this_thread::yield();
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ping_.store(next, std::memory_order_relaxed);
+            cv_.notify_all();
+            cv_.wait(lock, [&] { return pong_.load(std::memory_order_relaxed) == next; });
+        }
+    }
+};
+
+// Function to benchmark fiber switch, spawn and handoff costs against
+// ucontext and std::thread
+void benchmark_context_switch() {
+#ifdef ARENA_STORAGE_HAS_MMAP
+    constexpr size_t STACK_SIZE = 64 * 1024;
+    FiberStackPool pool(STACK_SIZE, 2);
+    
+    // Raw swapcontext ping-pong: each call is two switches
+    static ucontext_t uc_main, uc_fiber;
+    FiberStack uc_stack = pool.acquire();
+    getcontext(&uc_fiber);
+    uc_fiber.uc_stack.ss_sp = uc_stack.base;
+    uc_fiber.uc_stack.ss_size = uc_stack.size;
+    uc_fiber.uc_link = nullptr;
+    makecontext(&uc_fiber, [] {
+        while (true) {
+            swapcontext(&uc_fiber, &uc_main);
+        }
+    }, 0);
+    auto ucontext_test = [&]() {
+        swapcontext(&uc_main, &uc_fiber);
+    };
+    
+    // The same ping-pong through FiberContext, saving only callee-saved
+    // state, then saving SIMD/FPU state as well
+    static FiberContext fc_main, fc_fiber;
+    FiberStack fc_stack = pool.acquire();
+    fc_fiber.make(fc_stack.base, fc_stack.size, [](void*) {
+        while (true) {
+            FiberContext::swap(fc_fiber, fc_main);
+        }
+    }, nullptr);
+    auto context_test = [&]() {
+        FiberContext::swap(fc_main, fc_fiber);
+    };
+    
+    auto ucontext_result = Benchmark::run("ucontext swapcontext - Round trip", ucontext_test, 10);
+    auto lite_result = Benchmark::run("FiberContext LITE - Round trip", context_test, 10);
+    fc_main.set_mode(FiberContext::Mode::FULL);
+    fc_fiber.set_mode(FiberContext::Mode::FULL);
+    auto full_result = Benchmark::run("FiberContext FULL - Round trip", context_test, 10);
+    
+    // Yield between two fibers on one worker; measured from inside a fiber
+    FiberScheduler scheduler(1, 256 * 1024, 4);
+    std::atomic<bool> done(false);
+    Benchmark::Result yield_result("", std::chrono::nanoseconds(0), 0);
+    Benchmark::Result full_yield_result("", std::chrono::nanoseconds(0), 0);
+    for (FiberContext::Mode mode : {FiberContext::Mode::LITE, FiberContext::Mode::FULL}) {
+        bool lite = mode == FiberContext::Mode::LITE;
+        done.store(false);
+        scheduler.spawn([&] {
+            (lite ? yield_result : full_yield_result) = Benchmark::run(
+                lite ? "FiberScheduler LITE - Yield/resume round trip"
+                     : "FiberScheduler FULL - Yield/resume round trip",
+                [] { FiberScheduler::yield(); }, 10);
+            done.store(true);
+        }, mode);
+        scheduler.spawn([&] {
+            while (!done.load()) {
+                FiberScheduler::yield();
+            }
+        }, mode);
+        scheduler.wait();
+    }
+    
+    auto spawn_test = [&]() {
+        scheduler.spawn([] {});
+        scheduler.wait();
+    };
+    auto thread_spawn_test = [&]() {
+        std::thread thread([] {});
+        thread.join();
+    };
+    
+    auto spawn_result = Benchmark::run("FiberScheduler - Spawn+join", spawn_test, 10);
+    auto thread_spawn_result = Benchmark::run("std::thread - Spawn+join", thread_spawn_test, 10);
+    
+    Benchmark::Result condvar_result("", std::chrono::nanoseconds(0), 0);
+    Benchmark::Result spin_result("", std::chrono::nanoseconds(0), 0);
+    {
+        ThreadPingPong partner(false);
+        condvar_result = Benchmark::run("std::thread condvar - Handoff round trip",
+                                        [&] { partner.round_trip(); }, 10);
+    }
+    {
+        ThreadPingPong partner(true);
+        spin_result = Benchmark::run("std::thread atomic+yield - Handoff round trip",
+                                     [&] { partner.round_trip(); }, 10);
+    }
+    
+    Benchmark::print_result(ucontext_result);
+    Benchmark::print_result(lite_result);
+    Benchmark::print_result(full_result);
+    Benchmark::print_result(yield_result);
+    Benchmark::print_result(full_yield_result);
+    Benchmark::print_result(spawn_result);
+    Benchmark::print_result(thread_spawn_result);
+    Benchmark::print_result(condvar_result);
+    Benchmark::print_result(spin_result);
+    
+#if defined(__x86_64__)
+    // What each switch would pay on top of the callee-saved registers to
+    // save and restore FPU/SIMD state
+    std::cout << "State save+restore cost per switch:\n";
+    alignas(16) static char fx_area[512];
+    auto fxsave_test = [&]() {
+        asm volatile("fxsave64 (%0)\n\tfxrstor64 (%0)" : : "r"(fx_area) : "memory");
+    };
+    auto control_test = [&]() {
+        uint32_t mxcsr;
+        uint16_t fpucw;
+        asm volatile("stmxcsr %0\n\tfnstcw %1" : "=m"(mxcsr), "=m"(fpucw));
+        asm volatile("ldmxcsr %0\n\tfldcw %1" : : "m"(mxcsr), "m"(fpucw));
+    };
+    
+    auto control_result = Benchmark::run("MXCSR + x87 control word - Save/restore", control_test, 10);
+    auto fxsave_result = Benchmark::run("fxsave/fxrstor (x87 + SSE) - Save/restore", fxsave_test, 10);
+    Benchmark::print_result(control_result);
+    Benchmark::print_result(fxsave_result);
+    
+    size_t xsave_size = xsave_area_size();
+    if (xsave_size > 0) {
+        std::unique_ptr<char, decltype(&std::free)> xsave_area(
+            static_cast<char*>(std::aligned_alloc(64, (xsave_size + 63) / 64 * 64)), &std::free);
+        std::memset(xsave_area.get(), 0, xsave_size);
+        uint64_t mask = enabled_xstate();
+        uint32_t low = static_cast<uint32_t>(mask);
+        uint32_t high = static_cast<uint32_t>(mask >> 32);
+        char* area = xsave_area.get();
+        auto xsave_test = [&]() {
+            asm volatile("xsave64 (%0)\n\txrstor64 (%0)" : : "r"(area), "a"(low), "d"(high) : "memory");
+        };
+        auto xsave_result = Benchmark::run("xsave/xrstor (" + std::to_string(xsave_size) +
+                                           "-byte area) - Save/restore", xsave_test, 10);
+        Benchmark::print_result(xsave_result);
+    }
+#endif
+#else
+    std::cout << "mmap is not available on this platform\n";
+#endif
+}
+
+// Function to benchmark a pipe ping-pong between fibers through each
+// reactor backend against two threads doing blocking I/O
+void benchmark_fiber_io() {
+#if defined(ARENA_STORAGE_HAS_MMAP) && defined(__linux__)
+    std::vector<FiberReactor::Backend> backends{FiberReactor::Backend::EPOLL};
+    {
+        FiberScheduler probe_scheduler(1, 16 * 1024, 1);
+        FiberReactor probe(probe_scheduler);
+        if (probe.backend() == FiberReactor::Backend::IO_URING) {
+            backends.push_back(FiberReactor::Backend::IO_URING);
+        }
+    }
+    
+    std::vector<Benchmark::Result> results;
+    for (FiberReactor::Backend backend : backends) {
+        FiberScheduler scheduler(1, 256 * 1024, 4);
+        FiberReactor reactor(scheduler, 4096, 4, backend);
+        int ping[2], pong[2];
+        if (pipe2(ping, O_NONBLOCK | O_CLOEXEC) != 0 || pipe2(pong, O_NONBLOCK | O_CLOEXEC) != 0) {
+            std::cout << "pipe2 failed\n";
+            return;
+        }
+        
+        std::string name = backend == FiberReactor::Backend::IO_URING ? "FiberReactor io_uring" : "FiberReactor epoll";
+        scheduler.spawn([&] {
+            char byte;
+            results.push_back(Benchmark::run(name + " - Pipe round trip", [&] {
+                reactor.write(ping[1], "x", 1);
+                reactor.read(pong[0], &byte, 1);
+            }, 10));
+            reactor.write(ping[1], "q", 1);
+        });
+        scheduler.spawn([&] {
+            char byte;
+            while (reactor.read(ping[0], &byte, 1) == 1 && byte != 'q') {
+                reactor.write(pong[1], &byte, 1);
+            }
+        });
+        scheduler.wait();
+        for (int fd : {ping[0], ping[1], pong[0], pong[1]}) {
+            close(fd);
+        }
+    }
+    
+    // Blocking pipes between two threads
+    int ping[2], pong[2];
+    if (pipe2(ping, O_CLOEXEC) != 0 || pipe2(pong, O_CLOEXEC) != 0) {
+        std::cout << "pipe2 failed\n";
+        return;
+    }
+    std::thread echo([&] {
+        char byte;
+        while (::read(ping[0], &byte, 1) == 1 && byte != 'q') {
+            ssize_t written = ::write(pong[1], &byte, 1);
+            (void)written;
+        }
+    });
+    results.push_back(Benchmark::run("std::thread blocking - Pipe round trip", [&] {
+        char byte;
+        ssize_t written = ::write(ping[1], "x", 1);
+        ssize_t received = ::read(pong[0], &byte, 1);
+        Benchmark::DoNotOptimize(written + received);
+    }, 10));
+    ssize_t written = ::write(ping[1], "q", 1);
+    (void)written;
+    echo.join();
+    for (int fd : {ping[0], ping[1], pong[0], pong[1]}) {
+        close(fd);
+    }
+    
+    for (const Benchmark::Result& result : results) {
+        Benchmark::print_result(result);
+    }
+#else
+    std::cout << "Fiber I/O is not available on this platform\n";
+#endif
+}
+
+// One simulated request: format `fields` header lines of about 40 bytes,
+// grown in three appends so the longer ones leave the inline buffer
+template<typename String, typename... Resource>
+static size_t build_request_strings(size_t fields, const Resource&... resource) {
+    static const char* const names[] = {"Host", "Accept", "User-Agent", "X-Request-Id", "Cookie"};
+    size_t total = 0;
+    std::vector<String> lines;
+    lines.reserve(fields);
+    for (size_t i = 0; i < fields; ++i) {
+        String line(names[i % 5], resource...);
+        line += ": ";
+        line += "value-0123456789-abcdefghij";
+        total += line.size();
+        lines.push_back(std::move(line));
+    }
+    return total;
+}
+
+void benchmark_string_building(size_t requests, size_t fields) {
+    auto std_test = [=]() {
+        for (size_t r = 0; r < requests; ++r) {
+            Benchmark::DoNotOptimize(build_request_strings<std::string>(fields));
+        }
+    };
+    
+    auto heap_test = [=]() {
+        for (size_t r = 0; r < requests; ++r) {
+            Benchmark::DoNotOptimize(build_request_strings<MyString>(fields));
+        }
+    };
+    
+    // Per-request arena, released with one reset instead of a free per string
+    auto arena_test = [=]() {
+        BumpArena arena(fields * 64);
+        ArenaStringResource<BumpArena> strings(arena);
+        for (size_t r = 0; r < requests; ++r) {
+            Benchmark::DoNotOptimize(build_request_strings<ArenaString<BumpArena>>(fields, strings));
+            arena.reset();
+        }
+    };
+    
+    auto std_result = Benchmark::run("std::string - Request Headers", std_test, 10);
+    auto heap_result = Benchmark::run("MyString heap - Request Headers", heap_test, 10);
+    auto arena_result = Benchmark::run("ArenaString BumpArena - Request Headers", arena_test, 10);
+    
+    Benchmark::print_result(std_result);
+    Benchmark::print_result(heap_result);
+    Benchmark::print_result(arena_result);
+}
+
+// Header-parsing kernels on a ~1KB request head: each dispatch level the CPU
+// supports against the equivalent std::string operations
+void benchmark_string_kernels() {
+    std::string head = "GET /index.html HTTP/1.1\r\n";
+    for (int i = 0; head.size() < 1000; ++i) {
+        head += "X-Custom-Header-" + std::to_string(i) + ": some/Mixed-Case value; q=0.9\r\n";
+    }
+    head += "Content-Length: 42\r\n\r\n";
+    std::string token_a(64, 't'), token_b(64, 't');
+    token_b[60] = 'u';
+    
+    std::vector<Benchmark::Result> results;
+    results.push_back(Benchmark::run("std::string - find(\"Content-Length\")", [&] {
+        Benchmark::DoNotOptimize(head.find("Content-Length"));
+    }, 10));
+    results.push_back(Benchmark::run("std::string - rfind(':')", [&] {
+        Benchmark::DoNotOptimize(head.rfind(':', head.size() - 30));
+    }, 10));
+    results.push_back(Benchmark::run("std::string - compare 64 bytes", [&] {
+        Benchmark::DoNotOptimize(token_a.compare(token_b));
+    }, 10));
+    results.push_back(Benchmark::run("std::string - equals 64 bytes", [&] {
+        Benchmark::DoNotOptimize(token_a == token_b);
+    }, 10));
+    std::string scratch = head;
+    results.push_back(Benchmark::run("std::string - to_lower 1KB", [&] {
+        std::transform(scratch.begin(), scratch.end(), scratch.begin(), [](char ch) {
+            return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch + 32) : ch;
+        });
+        Benchmark::DoNotOptimize(scratch.data());
+    }, 10));
+    
+    for (StringKernels::Level level : {StringKernels::Level::GENERIC, StringKernels::Level::SSE42,
+                                       StringKernels::Level::AVX2}) {
+        if (!StringKernels::supported(level)) {
+            continue;
+        }
+        const StringKernels& kernels = StringKernels::get(level);
+        std::string prefix = std::string("StringKernels ") + kernels.name + " - ";
+        results.push_back(Benchmark::run(prefix + "find(\"Content-Length\")", [&] {
+            Benchmark::DoNotOptimize(kernels.find(head.data(), head.size(), "Content-Length", 14));
+        }, 10));
+        results.push_back(Benchmark::run(prefix + "rfind(':')", [&] {
+            Benchmark::DoNotOptimize(kernels.rfind_char(head.data(), head.size() - 29, ':'));
+        }, 10));
+        results.push_back(Benchmark::run(prefix + "compare 64 bytes", [&] {
+            Benchmark::DoNotOptimize(kernels.compare(token_a.data(), token_b.data(), 64));
+        }, 10));
+        results.push_back(Benchmark::run(prefix + "equals 64 bytes", [&] {
+            Benchmark::DoNotOptimize(kernels.equals(token_a.data(), token_b.data(), 64));
+        }, 10));
+        results.push_back(Benchmark::run(prefix + "to_lower 1KB", [&] {
+            kernels.to_lower(&scratch[0], scratch.size());
+            Benchmark::DoNotOptimize(scratch.data());
+        }, 10));
+        results.push_back(Benchmark::run(prefix + "length 1KB", [&] {
+            Benchmark::DoNotOptimize(kernels.length(head.c_str()));
+        }, 10));
+    }
+    
+    for (const Benchmark::Result& result : results) {
+        Benchmark::print_result(result);
+    }
+    std::cout << "Selected at startup: " << StringKernels::best().name << "\n";
+}
+
+// Log-line assembly: `messages` lines of 24 fields, each a name, '=', a
+// value and a number formatted per field. The arena versions format the
+// numbers into the arena, so the line being appended to is no longer the
+// latest allocation and has to move as it grows; the builder only records
+// the pieces and copies each once.
+void benchmark_string_builder(size_t messages) {
+    constexpr size_t FIELDS = 24;
+    std::vector<std::string> names, values;
+    for (size_t i = 0; i < FIELDS; ++i) {
+        names.push_back(" field_" + std::to_string(i));
+        values.push_back("value-of-field-" + std::to_string(i * 7));
+    }
+    
+    auto std_test = [&]() {
+        for (size_t m = 0; m < messages; ++m) {
+            std::string line;
+            for (size_t i = 0; i < FIELDS; ++i) {
+                line += names[i];
+                line += '=';
+                line += values[i];
+                line += std::to_string(m * FIELDS + i);
+            }
+            Benchmark::DoNotOptimize(line.data());
+        }
+    };
+    
+    auto arena_test = [&]() {
+        BumpArena arena(256 * 1024);
+        ArenaStringResource<BumpArena> strings(arena);
+        for (size_t m = 0; m < messages; ++m) {
+            ArenaString<BumpArena> line(strings);
+            for (size_t i = 0; i < FIELDS; ++i) {
+                char* digits = arena.alloc<char>(24);
+                size_t length = static_cast<size_t>(std::to_chars(digits, digits + 24, m * FIELDS + i).ptr - digits);
+                line += names[i];
+                line += '=';
+                line += values[i];
+                line += std::string_view(digits, length);
+            }
+            Benchmark::DoNotOptimize(line.data());
+            arena.reset();
+        }
+    };
+    
+    auto builder_test = [&]() {
+        BumpArena arena(256 * 1024);
+        for (size_t m = 0; m < messages; ++m) {
+            StringBuilder<BumpArena> builder(arena);
+            for (size_t i = 0; i < FIELDS; ++i) {
+                builder.append(names[i]).append("=").append(values[i]).append_number(m * FIELDS + i);
+            }
+            Benchmark::DoNotOptimize(builder.build_slice().data());
+            arena.reset();
+        }
+    };
+    
+    auto std_result = Benchmark::run("std::string += - Log Lines", std_test, 10);
+    auto arena_result = Benchmark::run("ArenaString += - Log Lines", arena_test, 10);
+    auto builder_result = Benchmark::run("StringBuilder build_slice - Log Lines", builder_test, 10);
+    
+    Benchmark::print_result(std_result);
+    Benchmark::print_result(arena_result);
+    Benchmark::print_result(builder_result);
+    
+    // Arena footprint of one line: moved-from buffers stay behind until reset
+    BumpArena arena(256 * 1024);
+    {
+        ArenaString<BumpArena> line{ArenaStringResource<BumpArena>(arena)};
+        for (size_t i = 0; i < FIELDS; ++i) {
+            char* digits = arena.alloc<char>(24);
+            size_t length = static_cast<size_t>(std::to_chars(digits, digits + 24, i).ptr - digits);
+            line += names[i];
+            line += '=';
+            line += values[i];
+            line += std::string_view(digits, length);
+        }
+    }
+    size_t appended = arena.used();
+    arena.reset();
+    StringBuilder<BumpArena> builder(arena);
+    for (size_t i = 0; i < FIELDS; ++i) {
+        builder.append(names[i]).append("=").append(values[i]).append_number(i);
+    }
+    builder.build_slice();
+    std::cout << "Arena bytes per line: ArenaString += " << appended << ", StringBuilder " << arena.used()
+              << " (line is " << builder.size() << " characters)\n";
+}
+
+static void print_usage(const char* program) {
+    std::cout << "Usage: " << program
+              << " [--json FILE] [--csv FILE] [--baseline FILE] [--threshold PCT] [--counters]"
+              << " [--threads N] [--trace FILE] [--save-trace FILE]\n"
+              << "  --json FILE       write results as JSON\n"
+              << "  --csv FILE        write results as CSV\n"
+              << "  --baseline FILE   compare medians against a saved JSON or CSV run\n"
+              << "  --threshold PCT   slowdown that counts as a regression (default 10)\n"
+              << "  --counters        capture hardware counters with perf_event_open\n"
+              << "  --threads N       largest thread count for the scaling suite (default: all cores)\n"
+              << "  --trace FILE      replay a recorded allocation trace instead of the synthetic one\n"
+              << "  --save-trace FILE write the trace being replayed to FILE\n";
+}
+
+int main(int argc, char** argv) {
+    std::string json_path;
+    std::string csv_path;
+    std::string baseline_path;
+    std::string trace_path;
+    std::string save_trace_path;
+    double threshold = 0.10;
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            threshold = std::strtod(argv[++i], nullptr) / 100.0;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            max_threads = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--save-trace" && i + 1 < argc) {
+            save_trace_path = argv[++i];
+        } else if (arg == "--counters") {
+            Benchmark::config().enable_counters = true;
+        } else {
+            print_usage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 2;
+        }
+    }
+    
+    // Load the baseline up front so a bad path fails before the long run
+    std::vector<Benchmark::Result> baseline;
+    if (!baseline_path.empty()) {
+        std::ifstream in(baseline_path);
+        if (!in) {
+            std::cerr << "Cannot read baseline " << baseline_path << std::endl;
+            return 2;
+        }
+        baseline = Benchmark::read_results(in);
+    }
+    
+    // Phased Zipfian mix on four threads unless a recorded trace is given
+    AllocTrace trace;
+    if (!trace_path.empty()) {
+        std::ifstream in(trace_path, std::ios::binary);
+        if (!in || !trace.load(in)) {
+            std::cerr << "Cannot read trace " << trace_path << std::endl;
+            return 2;
+        }
+    } else {
+        SyntheticTraceConfig trace_config;
+        trace_config.threads = 4;
+        trace = AllocTrace::synthesize(trace_config);
+    }
+    if (!save_trace_path.empty()) {
+        std::ofstream out(save_trace_path, std::ios::binary);
+        if (!trace.save(out)) {
+            std::cerr << "Cannot write trace " << save_trace_path << std::endl;
+            return 2;
+        }
+    }
+    
+    if (Benchmark::config().enable_counters && !PerfCounters().available()) {
+        std::cout << "Hardware counters unavailable; reporting wall time only\n";
+    }
+    
     std::cout << "Running benchmarks...\n\n";
     
     std::cout << "1. Small Allocations Test (10000 allocations)\n";
@@ -155,5 +1662,82 @@ int main() {
     std::cout << "\n3. Mixed Allocations Test\n";
     benchmark_mixed_allocations();
     
+    std::cout << "\n4. Aligned Allocations Test (10000 x 48 bytes at 64-byte alignment)\n";
+    benchmark_aligned_allocations(10000);
+    
+    std::cout << "\n5. Chained Arena Test (10000 int allocations)\n";
+    benchmark_chained_allocations(10000);
+    
+    std::cout << "\n6. Phased Allocations Test (100 messages x 3 phases x 1KB)\n";
+    benchmark_phased_allocations(100);
+    
+    std::cout << "\n7. Container Allocations Test (10000 elements)\n";
+    benchmark_container_allocations(10000);
+    
+    std::cout << "\n8. Pool Churn Test (100000 alloc/free pairs, 256 live objects)\n";
+    benchmark_pool_churn(100000);
+    
+    std::cout << "\n9. Size Class Churn Test (100000 mixed alloc/free pairs)\n";
+    benchmark_size_class_churn(100000);
+    
+    std::cout << "\n10. Storage Policy Test (64MB arena, 1000000 random node reads)\n";
+    benchmark_storage_policies(1000000);
+    
+    std::cout << "\n11. Batch Allocations Test (10000 char allocations)\n";
+    benchmark_batch_allocations(10000);
+    
+    std::cout << "\n12. Thread Scaling Test (10000 x 64-byte allocations per thread, up to "
+              << max_threads << " threads)\n";
+    benchmark_thread_scaling(max_threads);
+    
+    std::cout << "\n13. Trace Replay Test (" << (trace_path.empty() ? "synthetic" : trace_path) << ")\n";
+    benchmark_trace_replay(trace);
+    
+    std::cout << "\n14. Double-Ended Arena Test (100 frames x 50 temporaries + 10 kept blocks)\n";
+    benchmark_double_ended(100);
+    
+    std::cout << "\n15. Fiber Stack Test (1000 x 64KB guarded stacks)\n";
+    benchmark_fiber_stacks(1000);
+    
+    std::cout << "\n16. Context Switch Test (fibers vs ucontext vs std::thread)\n";
+    benchmark_context_switch();
+    
+    std::cout << "\n17. Fiber I/O Test (pipe ping-pong through the reactor vs blocking threads)\n";
+    benchmark_fiber_io();
+    
+    std::cout << "\n18. String Building Test (1000 requests x 100 header strings)\n";
+    benchmark_string_building(1000, 100);
+    
+    std::cout << "\n19. String Kernel Test (SIMD header parsing vs std::string)\n";
+    benchmark_string_kernels();
+    
+    std::cout << "\n20. String Builder Test (1000 log lines x 24 fields)\n";
+    benchmark_string_builder(1000);
+    
+    const auto& results = Benchmark::recorded();
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        Benchmark::write_json(out, results);
+    }
+    if (!csv_path.empty()) {
+        std::ofstream out(csv_path);
+        Benchmark::write_csv(out, results);
+    }
+    
+    if (!baseline_path.empty()) {
+        std::cout << "\nComparison against " << baseline_path << "\n";
+        auto comparisons = Benchmark::compare(baseline, results, threshold);
+        size_t failures = Benchmark::print_comparison(comparisons);
+        size_t missing = static_cast<size_t>(std::count_if(
+            comparisons.begin(), comparisons.end(), [](const Benchmark::Comparison& c) {
+                return c.status == Benchmark::Comparison::Status::MISSING;
+            }));
+        std::cout << failures - missing << " regression(s) beyond " << threshold * 100.0 << "%, "
+                  << missing << " baseline benchmark(s) missing\n";
+        if (failures > 0) {
+            return 1;
+        }
+    }
+    
     return 0;
 } 
\ No newline at end of file
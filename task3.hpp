@@ -1,63 +1,613 @@
 #ifndef BENCHMARK_HPP
 #define BENCHMARK_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <string>
+#include <fstream>
 #include <functional>
+#include <iterator>
+#include <sstream>
 #include <vector>
 #include <iostream>
+#include <thread>
+#include <memory>
+#include <utility>
+
+#include "perf_counters.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 class Benchmark {
 public:
+    using clock = std::chrono::steady_clock;
+
+    // Tuning for run(); shared by every benchmark in the process
+    struct Config {
+        std::chrono::nanoseconds warmup_time{std::chrono::milliseconds(10)};
+        std::chrono::nanoseconds min_sample_time{std::chrono::microseconds(200)};
+        std::chrono::nanoseconds target_time{std::chrono::milliseconds(200)};
+        size_t max_samples = 1000;
+        bool enable_counters = false;  // Capture PerfCounters during sampling
+    };
+
+    static Config& config() {
+        static Config instance;
+        return instance;
+    }
+
+    // Force `value` to be materialized so the computation producing it
+    // cannot be deleted by the optimizer
+    template<typename T>
+    static void DoNotOptimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    // Force all pending writes to memory to be considered observable
+    static void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
     // Function to measure execution time of a void function
     template<typename Func>
-    static auto measure(Func&& func) {
-        using namespace std::chrono;
-        
-        auto start = high_resolution_clock::now();
+    static std::chrono::nanoseconds measure(Func&& func) {
+        auto start = clock::now();
         std::forward<Func>(func)();
-        auto end = high_resolution_clock::now();
-        
-        return duration_cast<microseconds>(end - start);
+        ClobberMemory();
+        auto end = clock::now();
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
     }
-    
+
     // Function to run multiple iterations and get average time
     template<typename Func>
-    static auto measure_average(Func&& func, size_t iterations) {
-        using namespace std::chrono;
-        
-        microseconds total(0);
+    static std::chrono::nanoseconds measure_average(Func&& func, size_t iterations) {
+        std::chrono::nanoseconds total(0);
         for (size_t i = 0; i < iterations; ++i) {
             total += measure(func);
         }
-        
-        return microseconds(total.count() / iterations);
+
+        return std::chrono::nanoseconds(total.count() / static_cast<long long>(iterations));
+    }
+
+    // Run func(thread_index) on `threads` threads released together and
+    // return the wall time until the last one finishes. Where supported each
+    // thread is pinned to core thread_index % hardware_concurrency.
+    template<typename Func>
+    static std::chrono::nanoseconds measure_threads(size_t threads, Func&& func) {
+        std::atomic<size_t> ready(0);
+        std::atomic<bool> go(false);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                func(t);
+            });
+            pin_thread(workers.back(), t);
+        }
+
+        while (ready.load() < threads) {
+            std::this_thread::yield();
+        }
+        auto start = clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        auto end = clock::now();
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
     }
-    
-    // Struct to hold benchmark results
+
+    // Pin `thread` to core index % hardware_concurrency; no-op where unsupported
+    static void pin_thread(std::thread& thread, size_t index) {
+#if defined(__linux__)
+        unsigned cores = std::thread::hardware_concurrency();
+        if (cores == 0) {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cores, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)index;
+#endif
+    }
+
+    // Struct to hold benchmark results; times are nanoseconds per call
     struct Result {
         std::string name;
-        std::chrono::microseconds time;
-        size_t iterations;
-        
-        Result(const std::string& n, std::chrono::microseconds t, size_t i)
-            : name(n), time(t), iterations(i) {}
+        std::chrono::nanoseconds time;  // Median
+        size_t iterations;              // Samples taken
+        size_t batch;                   // Calls per sample
+        double min_ns;
+        double median_ns;
+        double mean_ns;
+        double p99_ns;
+        double stddev_ns;
+        std::vector<std::pair<std::string, double>> counters;  // Per call, if captured
+
+        Result(const std::string& n, std::chrono::nanoseconds t, size_t i)
+            : name(n), time(t), iterations(i), batch(1),
+              min_ns(static_cast<double>(t.count())), median_ns(min_ns), mean_ns(min_ns),
+              p99_ns(min_ns), stddev_ns(0) {}
     };
-    
-    // Function to run and record a benchmark
+
+    // Summarize per-call sample times into a Result
+    static Result summarize(const std::string& name, std::vector<double> samples, size_t batch) {
+        std::sort(samples.begin(), samples.end());
+        size_t n = samples.size();
+
+        double sum = 0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        double mean = sum / static_cast<double>(n);
+
+        double variance = 0;
+        for (double sample : samples) {
+            variance += (sample - mean) * (sample - mean);
+        }
+        variance = n > 1 ? variance / static_cast<double>(n - 1) : 0;
+
+        double median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        size_t p99_index = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(n)));
+
+        Result result(name, std::chrono::nanoseconds(static_cast<long long>(median)), n);
+        result.batch = batch;
+        result.min_ns = samples.front();
+        result.median_ns = median;
+        result.mean_ns = mean;
+        result.p99_ns = samples[p99_index > 0 ? p99_index - 1 : 0];
+        result.stddev_ns = std::sqrt(variance);
+        return result;
+    }
+
+    // Function to run and record a benchmark. After a warmup, calls are
+    // batched so each sample lasts at least min_sample_time, and samples are
+    // taken until target_time is spent (never fewer than `iterations`).
     template<typename Func>
     static Result run(const std::string& name, Func&& func, size_t iterations = 1) {
-        auto time = measure_average(std::forward<Func>(func), iterations);
-        return Result(name, time, iterations);
+        const Config& cfg = config();
+
+        // Warmup, which also estimates the cost of one call
+        size_t warmup_calls = 0;
+        std::chrono::nanoseconds warmup(0);
+        do {
+            warmup += measure(func);
+            ++warmup_calls;
+        } while (warmup < cfg.warmup_time);
+        double per_call = static_cast<double>(warmup.count()) / static_cast<double>(warmup_calls);
+        if (per_call < 1) {
+            per_call = 1;
+        }
+
+        size_t batch = batch_size(per_call);
+        size_t samples = sample_count(per_call, batch, iterations);
+
+        std::unique_ptr<PerfCounters> counters;
+        if (cfg.enable_counters) {
+            counters.reset(new PerfCounters());
+            counters->start();
+        }
+
+        std::vector<double> per_call_ns;
+        per_call_ns.reserve(samples);
+        for (size_t s = 0; s < samples; ++s) {
+            auto start = clock::now();
+            for (size_t b = 0; b < batch; ++b) {
+                func();
+                ClobberMemory();
+            }
+            auto end = clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+            per_call_ns.push_back(static_cast<double>(elapsed.count()) / static_cast<double>(batch));
+        }
+
+        if (counters) {
+            counters->stop();
+        }
+
+        Result result = summarize(name, std::move(per_call_ns), batch);
+        if (counters) {
+            result.counters = counters->read(samples * batch);
+        }
+        recorded().push_back(result);
+        return result;
+    }
+
+    // Like run(), for calls whose cost should not include everything they
+    // do: `sample` returns the duration to record for one call, such as the
+    // go-to-join time from measure_threads(), so per-call setup, thread
+    // spawning and pinning stay out of the result
+    template<typename Sample>
+    static Result run_timed(const std::string& name, Sample&& sample, size_t iterations = 1) {
+        const Config& cfg = config();
+
+        size_t warmup_calls = 0;
+        std::chrono::nanoseconds warmup(0);
+        auto warmup_start = clock::now();
+        clock::duration wall(0);
+        do {
+            warmup += std::chrono::nanoseconds(sample());
+            ++warmup_calls;
+            wall = clock::now() - warmup_start;
+        } while (wall < cfg.warmup_time);
+        double per_call = static_cast<double>(warmup.count()) / static_cast<double>(warmup_calls);
+        if (per_call < 1) {
+            per_call = 1;
+        }
+
+        // Batch on the recorded time, but budget samples on the wall time,
+        // which includes the untimed part of every call
+        double wall_per_call = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count()) / static_cast<double>(warmup_calls);
+        size_t batch = batch_size(per_call);
+        size_t samples = sample_count(std::max(wall_per_call, per_call), batch, iterations);
+
+        std::unique_ptr<PerfCounters> counters;
+        if (cfg.enable_counters) {
+            counters.reset(new PerfCounters());
+            counters->start();
+        }
+
+        std::vector<double> per_call_ns;
+        per_call_ns.reserve(samples);
+        for (size_t s = 0; s < samples; ++s) {
+            std::chrono::nanoseconds elapsed(0);
+            for (size_t b = 0; b < batch; ++b) {
+                elapsed += std::chrono::nanoseconds(sample());
+            }
+            per_call_ns.push_back(static_cast<double>(elapsed.count()) / static_cast<double>(batch));
+        }
+
+        // Counters cover the whole call, untimed parts included
+        if (counters) {
+            counters->stop();
+        }
+
+        Result result = summarize(name, std::move(per_call_ns), batch);
+        if (counters) {
+            result.counters = counters->read(samples * batch);
+        }
+        recorded().push_back(result);
+        return result;
+    }
+
+    // Every Result produced by run() or run_timed() so far, in order
+    static std::vector<Result>& recorded() {
+        static std::vector<Result> instance;
+        return instance;
     }
-    
+
     // Function to print benchmark results
     static void print_result(const Result& result) {
         std::cout << result.name << ": "
-                  << result.time.count() << " microseconds "
-                  << "(averaged over " << result.iterations << " iterations)"
+                  << format_ns(result.median_ns) << " median "
+                  << "(min " << format_ns(result.min_ns)
+                  << ", p99 " << format_ns(result.p99_ns)
+                  << ", stddev " << format_ns(result.stddev_ns)
+                  << ", " << result.iterations << " samples x " << result.batch << " calls)"
                   << std::endl;
+        if (!result.counters.empty()) {
+            std::cout << "    per call:";
+            for (const auto& counter : result.counters) {
+                std::cout << " " << counter.first << "=" << counter.second;
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    // Write results as a JSON array of objects
+    static void write_json(std::ostream& out, const std::vector<Result>& results) {
+        auto precision = out.precision(12);
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << "  {\"name\": \"" << escape_json(r.name) << "\""
+                << ", \"samples\": " << r.iterations
+                << ", \"batch\": " << r.batch
+                << ", \"min_ns\": " << r.min_ns
+                << ", \"median_ns\": " << r.median_ns
+                << ", \"mean_ns\": " << r.mean_ns
+                << ", \"p99_ns\": " << r.p99_ns
+                << ", \"stddev_ns\": " << r.stddev_ns;
+            if (!r.counters.empty()) {
+                out << ", \"counters\": {";
+                for (size_t c = 0; c < r.counters.size(); ++c) {
+                    out << (c ? ", " : "") << "\"" << r.counters[c].first << "\": "
+                        << r.counters[c].second;
+                }
+                out << "}";
+            }
+            out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "]\n";
+        out.precision(precision);
+    }
+
+    // Write results as CSV with a header row
+    static void write_csv(std::ostream& out, const std::vector<Result>& results) {
+        auto precision = out.precision(12);
+        out << "name,samples,batch,min_ns,median_ns,mean_ns,p99_ns,stddev_ns";
+        for (size_t event = 0; event < PerfCounters::EVENT_COUNT; ++event) {
+            out << ',' << PerfCounters::event_name(event);
+        }
+        out << '\n';
+        for (const Result& r : results) {
+            out << quote_csv(r.name) << ',' << r.iterations << ',' << r.batch << ','
+                << r.min_ns << ',' << r.median_ns << ',' << r.mean_ns << ','
+                << r.p99_ns << ',' << r.stddev_ns;
+
+            // Counter columns are left empty when not captured
+            for (size_t event = 0; event < PerfCounters::EVENT_COUNT; ++event) {
+                out << ',';
+                for (const auto& counter : r.counters) {
+                    if (counter.first == PerfCounters::event_name(event)) {
+                        out << counter.second;
+                    }
+                }
+            }
+            out << '\n';
+        }
+        out.precision(precision);
+    }
+
+    // Load results written by write_json() or write_csv(). Only the name and
+    // median are needed for comparison; other fields are restored when present.
+    static std::vector<Result> read_results(std::istream& in) {
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        size_t first = text.find_first_not_of(" \t\r\n");
+        if (first != std::string::npos && text[first] == '[') {
+            return parse_json(text);
+        }
+        return parse_csv(text);
+    }
+
+    // One row of a baseline comparison
+    struct Comparison {
+        enum class Status { OK, REGRESSED, ADDED, MISSING };
+
+        std::string name;
+        double baseline_ns;    // 0 for ADDED
+        double current_ns;     // 0 for MISSING
+        double ratio;          // current / baseline; 0 unless both ran
+        Status status;
+    };
+
+    // Compare medians against a baseline; a benchmark regresses when it is
+    // slower by more than `threshold` (0.10 = 10%). Benchmarks absent from
+    // the baseline are reported as ADDED, and baseline entries absent from
+    // this run as MISSING, so a rename or a dropped benchmark stays visible.
+    static std::vector<Comparison> compare(const std::vector<Result>& baseline,
+                                           const std::vector<Result>& current,
+                                           double threshold) {
+        std::vector<Comparison> comparisons;
+        for (const Result& r : current) {
+            auto match = std::find_if(baseline.begin(), baseline.end(),
+                                      [&r](const Result& b) { return b.name == r.name; });
+            if (match == baseline.end() || match->median_ns <= 0) {
+                comparisons.push_back(Comparison{r.name, 0, r.median_ns, 0, Comparison::Status::ADDED});
+                continue;
+            }
+            double ratio = r.median_ns / match->median_ns;
+            comparisons.push_back(Comparison{r.name, match->median_ns, r.median_ns, ratio,
+                                             ratio > 1.0 + threshold ? Comparison::Status::REGRESSED
+                                                                     : Comparison::Status::OK});
+        }
+        for (const Result& b : baseline) {
+            auto match = std::find_if(current.begin(), current.end(),
+                                      [&b](const Result& r) { return r.name == b.name; });
+            if (match == current.end()) {
+                comparisons.push_back(Comparison{b.name, b.median_ns, 0, 0, Comparison::Status::MISSING});
+            }
+        }
+        return comparisons;
+    }
+
+    // Print a comparison table and return the number of rows that fail the
+    // gate: regressions and baseline benchmarks missing from this run.
+    // Benchmarks new since the baseline are listed but do not fail it.
+    static size_t print_comparison(const std::vector<Comparison>& comparisons) {
+        size_t failures = 0;
+        for (const Comparison& c : comparisons) {
+            switch (c.status) {
+            case Comparison::Status::ADDED:
+                std::cout << "new: " << c.name << ": " << format_ns(c.current_ns)
+                          << " (not in baseline)" << std::endl;
+                break;
+            case Comparison::Status::MISSING:
+                std::cout << "MISSING: " << c.name << ": " << format_ns(c.baseline_ns)
+                          << " in baseline, not run" << std::endl;
+                ++failures;
+                break;
+            default: {
+                char change[32];
+                std::snprintf(change, sizeof(change), "%+.1f%%", (c.ratio - 1.0) * 100.0);
+                bool regressed = c.status == Comparison::Status::REGRESSED;
+                std::cout << (regressed ? "REGRESSION: " : "ok: ") << c.name << ": "
+                          << format_ns(c.baseline_ns) << " -> " << format_ns(c.current_ns)
+                          << " (" << change << ")" << std::endl;
+                failures += regressed ? 1 : 0;
+                break;
+            }
+            }
+        }
+        return failures;
+    }
+
+private:
+    // Calls per sample so each sample lasts at least min_sample_time
+    static size_t batch_size(double per_call) {
+        double min_sample = static_cast<double>(config().min_sample_time.count());
+        size_t batch = static_cast<size_t>(std::ceil(min_sample / per_call));
+        return batch == 0 ? 1 : batch;
+    }
+
+    // Samples that fit target_time, within max_samples and at least `iterations`
+    static size_t sample_count(double per_call, size_t batch, size_t iterations) {
+        const Config& cfg = config();
+        double sample_cost = per_call * static_cast<double>(batch);
+        size_t samples = static_cast<size_t>(static_cast<double>(cfg.target_time.count()) / sample_cost);
+        samples = std::min(samples, cfg.max_samples);
+        return std::max(samples, std::max<size_t>(iterations, 1));
+    }
+
+    static std::string format_ns(double ns) {
+        char buffer[32];
+        if (ns >= 1e6) {
+            std::snprintf(buffer, sizeof(buffer), "%.3f ms", ns / 1e6);
+        } else if (ns >= 1e3) {
+            std::snprintf(buffer, sizeof(buffer), "%.3f us", ns / 1e3);
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%.1f ns", ns);
+        }
+        return buffer;
+    }
+
+    static std::string escape_json(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    static std::string quote_csv(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"') {
+                quoted += '"';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    static Result make_result(const std::string& name, const std::vector<double>& fields) {
+        // fields: samples, batch, min, median, mean, p99, stddev
+        double median = fields.size() > 3 ? fields[3] : 0;
+        Result result(name, std::chrono::nanoseconds(static_cast<long long>(median)),
+                      fields.size() > 0 ? static_cast<size_t>(fields[0]) : 0);
+        result.batch = fields.size() > 1 ? static_cast<size_t>(fields[1]) : 1;
+        result.min_ns = fields.size() > 2 ? fields[2] : median;
+        result.median_ns = median;
+        result.mean_ns = fields.size() > 4 ? fields[4] : median;
+        result.p99_ns = fields.size() > 5 ? fields[5] : median;
+        result.stddev_ns = fields.size() > 6 ? fields[6] : 0;
+        return result;
+    }
+
+    static std::vector<Result> parse_csv(const std::string& text) {
+        std::vector<Result> results;
+        std::istringstream lines(text);
+        std::string line;
+        bool header = true;
+        while (std::getline(lines, line)) {
+            if (header || line.empty()) {
+                header = false;
+                continue;
+            }
+
+            // Quoted name, then numeric fields
+            std::string name;
+            size_t pos = 0;
+            if (!line.empty() && line[0] == '"') {
+                for (pos = 1; pos < line.size(); ++pos) {
+                    if (line[pos] == '"') {
+                        if (pos + 1 < line.size() && line[pos + 1] == '"') {
+                            name += '"';
+                            ++pos;
+                        } else {
+                            ++pos;
+                            break;
+                        }
+                    } else {
+                        name += line[pos];
+                    }
+                }
+            } else {
+                pos = line.find(',');
+                name = line.substr(0, pos);
+            }
+
+            std::vector<double> fields;
+            std::istringstream rest(pos < line.size() ? line.substr(pos + 1) : "");
+            std::string field;
+            while (std::getline(rest, field, ',')) {
+                fields.push_back(std::strtod(field.c_str(), nullptr));
+            }
+            results.push_back(make_result(name, fields));
+        }
+        return results;
+    }
+
+    // Reads the flat objects produced by write_json()
+    static std::vector<Result> parse_json(const std::string& text) {
+        static const char* const keys[] = {"samples", "batch", "min_ns", "median_ns",
+                                           "mean_ns", "p99_ns", "stddev_ns"};
+        std::vector<Result> results;
+        size_t pos = 0;
+        while ((pos = text.find('{', pos)) != std::string::npos) {
+            size_t end = text.find('}', pos);
+            if (end == std::string::npos) {
+                break;
+            }
+            std::string object = text.substr(pos, end - pos);
+            pos = end + 1;
+
+            std::string name;
+            size_t name_key = object.find("\"name\"");
+            if (name_key != std::string::npos) {
+                size_t i = object.find('"', object.find(':', name_key)) + 1;
+                for (; i < object.size() && object[i] != '"'; ++i) {
+                    if (object[i] == '\\' && i + 1 < object.size()) {
+                        ++i;
+                    }
+                    name += object[i];
+                }
+            }
+
+            std::vector<double> fields;
+            for (const char* key : keys) {
+                size_t key_pos = object.find(std::string("\"") + key + "\"");
+                if (key_pos == std::string::npos) {
+                    fields.push_back(0);
+                    continue;
+                }
+                size_t colon = object.find(':', key_pos);
+                fields.push_back(std::strtod(object.c_str() + colon + 1, nullptr));
+            }
+            results.push_back(make_result(name, fields));
+        }
+        return results;
     }
 };
 
-#endif // BENCHMARK_HPP 
\ No newline at end of file
+#endif // BENCHMARK_HPP
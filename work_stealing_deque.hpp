@@ -0,0 +1,99 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Chase-Lev work-stealing deque of pointers with a fixed power-of-two
+// capacity (memory orderings after Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models"). The owning thread pushes and pops
+// at the bottom; any thread may steal from the top. push() returns false
+// when full; pop() and steal() return nullptr when empty or, for steal(),
+// when it lost a race.
+template<typename T, size_t Capacity = 1024>
+class WorkStealingDeque {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+private:
+    static constexpr int64_t MASK = static_cast<int64_t>(Capacity) - 1;
+
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    alignas(64) std::atomic<T*> items_[Capacity];
+
+public:
+    WorkStealingDeque() : top_(0), bottom_(0) {
+        for (std::atomic<T*>& item : items_) {
+            item.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only
+    bool push(T* item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<int64_t>(Capacity)) {
+            return false;
+        }
+        items_[bottom & MASK].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only; takes the most recently pushed item
+    T* pop() {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = items_[bottom & MASK].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last item: race the thieves for it
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread; takes the oldest item
+    T* steal() {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        T* item = items_[top & MASK].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // Method to get an approximate item count
+    size_t size() const {
+        int64_t count = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+        return count > 0 ? static_cast<size_t>(count) : 0;
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+};
+
+#endif // WORK_STEALING_DEQUE_HPP